@@ -0,0 +1,89 @@
+//
+//  cxxsubs
+//
+//  https://github.com/edmBernard/cxxsubs
+//
+//  Copyright (c) 2018 Erwan BERNARD. All rights reserved.
+//  Distributed under the Apache License, Version 2.0. (See accompanying
+//  file LICENSE or copy at http://www.apache.org/licenses/LICENSE-2.0)
+//
+
+// Dispatches per second of one cxxsubs::ConcurrentDispatcher shared by 1 to 64 threads
+
+#include "cxxsubs.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+class OptionsShipMove : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "move"}, "Move one of your ship"};
+
+  OptionsShipMove()
+      : cxxsubs::IOptions(verb) {
+
+    // clang-format off
+    this->options.add_options()
+      ("name", "name of the ship", cxxopts::value<std::string>())
+      ("x", "x coordinate", cxxopts::value<int>())
+      ("y", "y coordinate", cxxopts::value<int>()->default_value("0"));
+
+    // clang-format on
+    options.parse_positional({"name", "x", "y"});
+  }
+
+  int validate(const cxxsubs::Context &context) const {
+    return context.result.count("x") ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  int exec(const cxxsubs::Context &context) const {
+    return context.result["x"].as<int>() + context.result["y"].as<int>() == 3 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+};
+
+class OptionsShipNew : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "new"}, "Create a new ship"};
+
+  OptionsShipNew()
+      : cxxsubs::IOptions(verb) {
+  }
+
+  int exec(const cxxsubs::Context &) const {
+    return EXIT_SUCCESS;
+  }
+};
+
+int main() {
+  cxxsubs::ConcurrentDispatcher<OptionsShipNew, OptionsShipMove> dispatcher;
+  const char *argv[] = {"bench", "ship", "move", "titanic", "1", "2", nullptr};
+  const int dispatches = 100000;
+
+  double single = 0;
+  for (unsigned threads = 1; threads <= 64; threads *= 2) {
+    std::atomic<int> failures{0};
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&]() {
+        std::string text;
+        cxxsubs::Output output(text);
+        for (int k = 0; k < dispatches; ++k) {
+          failures += dispatcher.dispatch(6, argv, output) != EXIT_SUCCESS;
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double rate = threads * double(dispatches) / seconds;
+    if (threads == 1) {
+      single = rate;
+    }
+    std::cout << threads << " threads: " << rate / 1e6 << " M dispatches/s, x" << rate / single << " (" << failures << " failures)\n";
+  }
+  std::cout << "hardware threads: " << std::thread::hardware_concurrency() << "\n";
+  return EXIT_SUCCESS;
+}
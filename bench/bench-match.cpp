@@ -0,0 +1,140 @@
+//
+//  cxxsubs
+//
+//  https://github.com/edmBernard/cxxsubs
+//
+//  Copyright (c) 2018 Erwan BERNARD. All rights reserved.
+//  Distributed under the Apache License, Version 2.0. (See accompanying
+//  file LICENSE or copy at http://www.apache.org/licenses/LICENSE-2.0)
+//
+
+// Allocations and time of a full dispatch among many verbs, from the match of argv to the exec
+
+#include "cxxsubs.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <utility>
+
+static std::size_t allocations = 0;
+
+void *operator new(std::size_t size) {
+  ++allocations;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+
+//! Name of the I-th verb: v0000, v0001, ... in ten groups: g0 to g9
+template <std::size_t I>
+struct VerbName {
+  static constexpr char value[] = {'v', char('0' + I / 1000 % 10), char('0' + I / 100 % 10), char('0' + I / 10 % 10), char('0' + I % 10), '\0'};
+  static constexpr char group[] = {'g', char('0' + I % 10), '\0'};
+};
+
+//! Write its name and count its flags
+class OptionsBench : public cxxsubs::IOptions {
+public:
+  using cxxsubs::IOptions::IOptions;
+
+  int exec() {
+    this->out() << (*this->parse_result)["name"].as<std::string>() << " " << this->parse_result->count("flag") << "\n";
+    return EXIT_SUCCESS;
+  }
+
+protected:
+  void add_bench_options() {
+    // clang-format off
+    this->options.add_options()
+      ("f,flag", "a flag")
+      ("name", "a name", cxxopts::value<std::string>());
+    // clang-format on
+    this->options.parse_positional({"name"});
+  }
+};
+
+//! Verb given at runtime, matched against argv by IOptions::match in each dispatch
+template <std::size_t I>
+class RuntimeVerb : public OptionsBench {
+public:
+  RuntimeVerb()
+      : OptionsBench({VerbName<I>::group, VerbName<I>::value}, "benchmark verb") {
+    this->add_bench_options();
+  }
+};
+
+//! Verb declared at compile time, found in the verb table
+template <std::size_t I>
+class StaticVerb : public OptionsBench {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{VerbName<I>::group, VerbName<I>::value}, "benchmark verb"};
+
+  StaticVerb()
+      : OptionsBench(verb) {
+    this->add_bench_options();
+  }
+};
+
+//! Drop the output of the verbs
+class NullBuffer : public std::streambuf {
+protected:
+  std::streamsize xsputn(const char *, std::streamsize count) override {
+    return count;
+  }
+  int_type overflow(int_type ch) override {
+    return traits_type::not_eof(ch);
+  }
+};
+
+template <typename Function>
+void measure(const char *name, int iterations, Function function) {
+  std::size_t failures = 0;
+  std::size_t before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int k = 0; k < iterations; ++k) {
+    failures += function() != EXIT_SUCCESS;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << name << ": " << double(allocations - before) / iterations << " allocations, "
+            << std::chrono::duration<double, std::nano>(elapsed).count() / iterations << " ns per dispatch (" << failures << " failures)\n";
+}
+
+template <typename Sequence>
+struct Benchmark;
+
+template <std::size_t... Indices>
+struct Benchmark<std::index_sequence<Indices...>> {
+  static void run(int iterations) {
+    constexpr std::size_t last = sizeof...(Indices) - 1;
+    const char *argv[] = {"bench", VerbName<last>::group, VerbName<last>::value, "--flag", "Nautilus", nullptr};
+    NullBuffer null;
+    cxxsubs::Output output(&null);
+
+    std::cout << "dispatching among " << sizeof...(Indices) << " verbs\n";
+    cxxsubs::Dispatcher<RuntimeVerb<Indices>...> runtime;
+    measure("runtime verbs", iterations, [&]() { return runtime.dispatch(5, argv, output); });
+
+    cxxsubs::Dispatcher<StaticVerb<Indices>...> dispatcher;
+    // options of a static verb are constructed at its first dispatch
+    dispatcher.dispatch(5, argv, output);
+    measure("static verbs", iterations, [&]() { return dispatcher.dispatch(5, argv, output); });
+
+    cxxsubs::utils::scoped_output scope(&output);
+    measure("static verbs, one-shot Verbs", iterations, [&]() { return cxxsubs::Verbs<StaticVerb<Indices>...>(5, argv); });
+  }
+};
+
+int main() {
+  Benchmark<std::make_index_sequence<150>>::run(20000);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+//
+//  cxxsubs
+//
+//  https://github.com/edmBernard/cxxsubs
+//
+//  Copyright (c) 2018 Erwan BERNARD. All rights reserved.
+//  Distributed under the Apache License, Version 2.0. (See accompanying
+//  file LICENSE or copy at http://www.apache.org/licenses/LICENSE-2.0)
+//
+
+// Parse of 1M numeric positional arguments, integers and floating point
+
+#define CXXOPTS_NO_REGEX
+#include "cxxopts.hpp"
+#include <chrono>
+#include <iostream>
+
+template <typename T>
+void run(const char *name, const std::vector<std::string> &values) {
+  std::vector<const char *> argv = {"bench", "--"};
+  for (auto &value : values) {
+    argv.push_back(value.c_str());
+  }
+  cxxopts::Options options("bench");
+  options.add_options()("values", "", cxxopts::value<std::vector<T>>());
+  options.parse_positional({"values"});
+
+  auto start = std::chrono::steady_clock::now();
+  auto result = options.parse(int(argv.size()), argv.data());
+  double parse = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // conversion alone, without the parser
+  double sum = 0;
+  start = std::chrono::steady_clock::now();
+  for (auto &value : values) {
+    T converted;
+    cxxopts::values::parse_value(value, converted);
+    sum += double(converted);
+  }
+  double conversion = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << name << ": parse " << parse * 1e3 << " ms, parse_value alone " << conversion * 1e3 << " ms ("
+            << result["values"].as<std::vector<T>>().size() << " values, sum " << sum << ")\n";
+}
+
+int main() {
+  std::vector<std::string> integers;
+  std::vector<std::string> floats;
+  for (int i = 0; i < 1000000; ++i) {
+    integers.push_back(std::to_string(i * 7 - 3000000));
+    floats.push_back(std::to_string(i * 0.37 - 1000.0));
+  }
+  run<int>("int", integers);
+  run<double>("double", floats);
+  return EXIT_SUCCESS;
+}
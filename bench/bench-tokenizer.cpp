@@ -0,0 +1,84 @@
+//
+//  cxxsubs
+//
+//  https://github.com/edmBernard/cxxsubs
+//
+//  Copyright (c) 2018 Erwan BERNARD. All rights reserved.
+//  Distributed under the Apache License, Version 2.0. (See accompanying
+//  file LICENSE or copy at http://www.apache.org/licenses/LICENSE-2.0)
+//
+
+// Arguments per second of cxxopts on a 10k arguments command line, define CXXSUBS_REGEX to
+// measure the std::regex path
+
+#if !defined(CXXSUBS_REGEX)
+#define CXXOPTS_NO_REGEX
+#endif
+#include "cxxopts.hpp"
+#include <chrono>
+#include <iostream>
+
+int main() {
+  std::vector<std::string> storage = {"bench"};
+  for (int i = 0; i < 10000; ++i) {
+    switch (i % 5) {
+    case 0:
+      storage.push_back("--moored");
+      break;
+    case 1:
+      storage.push_back("--name=ship" + std::to_string(i));
+      break;
+    case 2:
+      storage.push_back("-abc");
+      break;
+    case 3:
+      storage.push_back("positional" + std::to_string(i));
+      break;
+    default:
+      storage.push_back("--drift-ing_x");
+      break;
+    }
+  }
+  std::vector<const char *> argv;
+  for (auto &arg : storage) {
+    argv.push_back(arg.c_str());
+  }
+  const double arguments = double(argv.size() - 1);
+
+  // classification of each argument alone
+  std::size_t checksum = 0;
+  const int repetitions = 100;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < repetitions; ++r) {
+    for (std::size_t i = 1; i < argv.size(); ++i) {
+      bool matched = false;
+      auto argument = cxxopts::values::parser_tool::ParseArgument(argv[i], matched);
+      checksum += matched + argument.arg_name.size();
+    }
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "tokenize: " << repetitions * arguments / seconds / 1e6 << " M args/s\n";
+
+  // full parse of the command line
+  cxxopts::Options options("bench");
+  // clang-format off
+  options.add_options()
+    ("moored", "", cxxopts::value<bool>())
+    ("drift-ing_x", "", cxxopts::value<bool>())
+    ("n,name", "", cxxopts::value<std::vector<std::string>>())
+    ("a", "", cxxopts::value<bool>())
+    ("b", "", cxxopts::value<bool>())
+    ("c", "", cxxopts::value<bool>())
+    ("positional", "", cxxopts::value<std::vector<std::string>>());
+  // clang-format on
+  options.parse_positional({"positional"});
+  const int parses = 20;
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < parses; ++r) {
+    auto result = options.parse(int(argv.size()), argv.data());
+    checksum += result.count("positional");
+  }
+  seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "parse: " << parses * arguments / seconds / 1e6 << " M args/s (" << checksum << ")\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+//
+//  cxxsubs
+//
+//  https://github.com/edmBernard/cxxsubs
+//
+//  Copyright (c) 2018 Erwan BERNARD. All rights reserved.
+//  Distributed under the Apache License, Version 2.0. (See accompanying
+//  file LICENSE or copy at http://www.apache.org/licenses/LICENSE-2.0)
+//
+
+// Verb resolution with the compile-time verb table against a linear scan matching each verb
+
+#include "cxxsubs.hpp"
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+//! Name of the I-th verb: v0000, v0001, ...
+template <std::size_t I>
+struct VerbName {
+  static constexpr char value[] = {'v', char('0' + I / 1000 % 10), char('0' + I / 100 % 10), char('0' + I / 10 % 10), char('0' + I % 10), '\0'};
+};
+
+template <std::size_t I>
+class OptionsVerb : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"group", VerbName<I>::value}, "benchmark verb"};
+
+  OptionsVerb()
+      : cxxsubs::IOptions(verb) {
+  }
+
+  int validate() {
+    return EXIT_SUCCESS;
+  }
+
+  int exec() {
+    return EXIT_SUCCESS;
+  }
+};
+
+template <typename Sequence>
+struct Benchmark;
+
+template <std::size_t... Indices>
+struct Benchmark<std::index_sequence<Indices...>> {
+  static void run(int iterations) {
+    constexpr std::size_t count = sizeof...(Indices);
+    const char *argv[] = {"bench", "group", VerbName<count / 2>::value, nullptr};
+    std::size_t hits = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < iterations; ++k) {
+      const cxxsubs::utils::VerbEntry *entry = cxxsubs::utils::lookup(cxxsubs::utils::verb_table<OptionsVerb<Indices>...>, 3, argv);
+      hits += entry && entry->index == count / 2;
+    }
+    auto table = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int k = 0; k < iterations; ++k) {
+      // one match per verb, as Verbs did before the verb table
+      bool matches[count] = {};
+      std::size_t i = 0;
+      ((matches[i++] = cxxsubs::utils::match(std::vector<std::string>{"group", VerbName<Indices>::value}, 3, argv)), ...);
+      hits += matches[count / 2];
+    }
+    auto linear = std::chrono::steady_clock::now() - start;
+
+    std::cout << count << " verbs: table " << std::chrono::duration<double, std::nano>(table).count() / iterations << " ns, linear scan "
+              << std::chrono::duration<double, std::nano>(linear).count() / iterations << " ns (" << hits << " hits)\n";
+  }
+};
+
+int main() {
+  Benchmark<std::make_index_sequence<10>>::run(200000);
+  Benchmark<std::make_index_sequence<100>>::run(20000);
+  Benchmark<std::make_index_sequence<1000>>::run(2000);
+  return EXIT_SUCCESS;
+}
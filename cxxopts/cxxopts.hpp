@@ -26,15 +26,19 @@ THE SOFTWARE.
 #define CXXOPTS_HPP_INCLUDED
 
 #include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <exception>
 #include <iostream>
 #include <limits>
-#include <list>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -333,8 +337,16 @@ namespace cxxopts
     std::shared_ptr<Value>
     clone() const = 0;
 
+    // Clone with the storage allocated from resource, it must outlive the clone
+    virtual
+    std::shared_ptr<Value>
+    clone(std::pmr::memory_resource* /*resource*/) const
+    {
+      return clone();
+    }
+
     virtual void
-    parse(const std::string& text) const = 0;
+    parse(std::string_view text) const = 0;
 
     virtual void
     parse() const = 0;
@@ -348,10 +360,10 @@ namespace cxxopts
     virtual bool
     has_implicit() const = 0;
 
-    virtual std::string
+    virtual const std::string&
     get_default_value() const = 0;
 
-    virtual std::string
+    virtual const std::string&
     get_implicit_value() const = 0;
 
     virtual std::shared_ptr<Value>
@@ -365,6 +377,13 @@ namespace cxxopts
 
     virtual bool
     is_boolean() const = 0;
+
+    // Identity of the stored type, null when unknown, compared without RTTI
+    virtual const void*
+    type() const
+    {
+      return nullptr;
+    }
   };
 #if defined(__GNUC__)
 #pragma GCC diagnostic pop
@@ -557,19 +576,23 @@ namespace cxxopts
         std::string base     = "";
         std::string value    = "";
       };
+      // name and value point in the parsed argument
       struct ArguDesc {
-        std::string arg_name  = "";
-        bool        grouping  = false;
-        bool        set_value = false;
-        std::string value     = "";
+        std::string_view arg_name  = "";
+        bool             grouping  = false;
+        bool             set_value = false;
+        std::string_view value     = "";
       };
 #ifdef CXXOPTS_NO_REGEX
+      // [[:alnum:]] of the regex version, in the C locale
+      inline bool IsAlnum(char c)
+      {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+      }
+
+      // (-)?(0x)?([0-9a-zA-Z]+)|((0x)?0)
       inline IntegerDesc SplitInteger(const std::string &text)
       {
-        if (text.empty())
-        {
-          throw_or_mimic<argument_incorrect_type>(text);
-        }
         IntegerDesc desc;
         const char *pdata = text.c_str();
         if (*pdata == '-')
@@ -577,128 +600,119 @@ namespace cxxopts
           pdata += 1;
           desc.negative = "-";
         }
-        if (strncmp(pdata, "0x", 2) == 0)
+        // 0x alone is a value, not a base
+        if (pdata[0] == '0' && pdata[1] == 'x' && pdata[2] != '\0')
         {
           pdata += 2;
           desc.base = "0x";
         }
-        if (*pdata != '\0')
+        const char *value = pdata;
+        while (IsAlnum(*pdata))
         {
-          desc.value = std::string(pdata);
+          pdata += 1;
         }
-        else
+        if (pdata == value || *pdata != '\0')
         {
           throw_or_mimic<argument_incorrect_type>(text);
         }
+        desc.value = std::string(value, std::size_t(pdata - value));
         return desc;
       }
 
+      // (t|T)(rue)?|1
       inline bool IsTrueText(const std::string &text)
       {
-        const char *pdata = text.c_str();
-        if (*pdata == 't' || *pdata == 'T')
-        {
-          pdata += 1;
-          if (strncmp(pdata, "rue\0", 4) == 0)
-          {
-            return true;
-          }
-        }
-        else if (strncmp(pdata, "1\0", 2) == 0)
-        {
-          return true;
-        }
-        return false;
+        return text == "1" || text == "t" || text == "T" || text == "true" || text == "True";
       }
 
+      // (f|F)(alse)?|0
       inline bool IsFalseText(const std::string &text)
       {
-        const char *pdata = text.c_str();
-        if (*pdata == 'f' || *pdata == 'F')
-        {
-          pdata += 1;
-          if (strncmp(pdata, "alse\0", 5) == 0)
-          {
-            return true;
-          }
-        }
-        else if (strncmp(pdata, "0\0", 2) == 0)
-        {
-          return true;
-        }
-        return false;
+        return text == "0" || text == "f" || text == "F" || text == "false" || text == "False";
       }
 
+      // (([[:alnum:]]),)?[ ]*([[:alnum:]][-_[:alnum:]]*)?
       inline std::pair<std::string, std::string> SplitSwitchDef(const std::string &text)
       {
         std::string short_sw, long_sw;
         const char *pdata = text.c_str();
-        if (isalnum(*pdata) && *(pdata + 1) == ',') {
+        if (IsAlnum(*pdata) && *(pdata + 1) == ',') {
           short_sw = std::string(1, *pdata);
           pdata += 2;
         }
         while (*pdata == ' ') { pdata += 1; }
-        if (isalnum(*pdata)) {
+        if (IsAlnum(*pdata)) {
           const char *store = pdata;
           pdata += 1;
-          while (isalnum(*pdata) || *pdata == '-' || *pdata == '_') {
+          while (IsAlnum(*pdata) || *pdata == '-' || *pdata == '_') {
             pdata += 1;
           }
-          if (*pdata == '\0') {
-            long_sw = std::string(store, pdata - store);
-          } else {
-            throw_or_mimic<invalid_option_format_error>(text);
-          }
+          long_sw = std::string(store, pdata - store);
+        }
+        if (*pdata != '\0') {
+          throw_or_mimic<invalid_option_format_error>(text);
         }
         return std::pair<std::string, std::string>(short_sw, long_sw);
       }
 
+      // --([[:alnum:]][-_[:alnum:]]+)(=(.*))?|-([[:alnum:]]+)
+      // Single pass over the argument, name and value point in it so nothing is allocated
       inline ArguDesc ParseArgument(const char *arg, bool &matched)
       {
         ArguDesc argu_desc;
         const char *pdata = arg;
         matched = false;
-        if (strncmp(pdata, "--", 2) == 0)
+        if (pdata[0] == '-' && pdata[1] == '-')
         {
           pdata += 2;
-          if (isalnum(*pdata))
+          const char *name = pdata;
+          if (!IsAlnum(*pdata))
+          {
+            return argu_desc;
+          }
+          pdata += 1;
+          while (IsAlnum(*pdata) || *pdata == '-' || *pdata == '_')
           {
-            argu_desc.arg_name.push_back(*pdata);
             pdata += 1;
-            while (isalnum(*pdata) || *pdata == '-' || *pdata == '_')
+          }
+          if (pdata - name < 2 || (*pdata != '=' && *pdata != '\0'))
+          {
+            return argu_desc;
+          }
+          argu_desc.arg_name = std::string_view(name, std::size_t(pdata - name));
+          if (*pdata == '=')
+          {
+            // . of the regex version don't match line terminators
+            const char *value = pdata + 1;
+            pdata = value;
+            while (*pdata != '\0' && *pdata != '\n' && *pdata != '\r')
             {
-              argu_desc.arg_name.push_back(*pdata);
               pdata += 1;
             }
-            if (argu_desc.arg_name.length() > 1)
+            if (*pdata != '\0')
             {
-              if (*pdata == '=')
-              {
-                argu_desc.set_value = true;
-                pdata += 1;
-                if (*pdata != '\0')
-                {
-                  argu_desc.value = std::string(pdata);
-                }
-                matched = true;
-              }
-              else if (*pdata == '\0')
-              {
-                matched = true;
-              }
+              argu_desc.arg_name = std::string_view();
+              return argu_desc;
             }
+            argu_desc.set_value = true;
+            argu_desc.value = std::string_view(value, std::size_t(pdata - value));
           }
+          matched = true;
         }
-        else if (strncmp(pdata, "-", 1) == 0)
+        else if (pdata[0] == '-')
         {
           pdata += 1;
-          argu_desc.grouping = true;
-          while (isalnum(*pdata))
+          const char *name = pdata;
+          while (IsAlnum(*pdata))
           {
-            argu_desc.arg_name.push_back(*pdata);
             pdata += 1;
           }
-          matched = !argu_desc.arg_name.empty() && *pdata == '\0';
+          if (pdata != name && *pdata == '\0')
+          {
+            argu_desc.grouping = true;
+            argu_desc.arg_name = std::string_view(name, std::size_t(pdata - name));
+            matched = true;
+          }
         }
         return argu_desc;
       }
@@ -784,13 +798,13 @@ namespace cxxopts
 
         ArguDesc argu_desc;
         if (matched) {
-          argu_desc.arg_name = result[1].str();
+          argu_desc.arg_name = std::string_view(result[1].first, std::size_t(result[1].length()));
           argu_desc.set_value = result[2].length() > 0;
-          argu_desc.value = result[3].str();
+          argu_desc.value = std::string_view(result[3].first, std::size_t(result[3].length()));
           if (result[4].length() > 0)
           {
             argu_desc.grouping = true;
-            argu_desc.arg_name = result[4].str();
+            argu_desc.arg_name = std::string_view(result[4].first, std::size_t(result[4].length()));
           }
         }
 
@@ -811,20 +825,20 @@ namespace cxxopts
       {
         template <typename U>
         void
-        operator()(bool negative, U u, const std::string& text)
+        operator()(bool negative, U u, std::string_view text)
         {
           if (negative)
           {
             if (u > static_cast<U>((std::numeric_limits<T>::min)()))
             {
-              throw_or_mimic<argument_incorrect_type>(text);
+              throw_or_mimic<argument_incorrect_type>(std::string(text));
             }
           }
           else
           {
             if (u > static_cast<U>((std::numeric_limits<T>::max)()))
             {
-              throw_or_mimic<argument_incorrect_type>(text);
+              throw_or_mimic<argument_incorrect_type>(std::string(text));
             }
           }
         }
@@ -835,12 +849,12 @@ namespace cxxopts
       {
         template <typename U>
         void
-        operator()(bool, U, const std::string&) const {}
+        operator()(bool, U, std::string_view) const {}
       };
 
       template <typename T, typename U>
       void
-      check_signed_range(bool negative, U value, const std::string& text)
+      check_signed_range(bool negative, U value, std::string_view text)
       {
         SignedCheck<T, std::numeric_limits<T>::is_signed>()(negative, value, text);
       }
@@ -848,7 +862,7 @@ namespace cxxopts
 
     template <typename R, typename T>
     void
-    checked_negate(R& r, T&& t, const std::string&, std::true_type)
+    checked_negate(R& r, T&& t, std::string_view, std::true_type)
     {
       // if we got to here, then `t` is a positive number that fits into
       // `R`. So to avoid MSVC C4146, we first cast it to `R`.
@@ -858,54 +872,41 @@ namespace cxxopts
 
     template <typename R, typename T>
     void
-    checked_negate(R&, T&&, const std::string& text, std::false_type)
+    checked_negate(R&, T&&, std::string_view text, std::false_type)
     {
-      throw_or_mimic<argument_incorrect_type>(text);
+      throw_or_mimic<argument_incorrect_type>(std::string(text));
     }
 
+    // [-][0x]digits, the magnitude is read with std::from_chars then range checked. Spaces
+    // and '+' are rejected, values out of the range of T are rejected, they never wrap around
     template <typename T>
     void
-    integer_parser(const std::string& text, T& value)
+    integer_parser(std::string_view text, T& value)
     {
-      parser_tool::IntegerDesc int_desc = parser_tool::SplitInteger(text);
-
       using US = typename std::make_unsigned<T>::type;
       constexpr bool is_signed = std::numeric_limits<T>::is_signed;
 
-      const bool          negative    = int_desc.negative.length() > 0;
-      const uint8_t       base        = int_desc.base.length() > 0 ? 16 : 10;
-      const std::string & value_match = int_desc.value;
+      const char* first = text.data();
+      const char* last = first + text.size();
+      const bool negative = first != last && *first == '-';
+      if (negative)
+      {
+        ++first;
+      }
+      // 0x alone is not a base prefix, it's then rejected as a decimal value
+      int base = 10;
+      if (last - first > 2 && first[0] == '0' && first[1] == 'x')
+      {
+        first += 2;
+        base = 16;
+      }
 
+      // from_chars on an unsigned type reject a second sign
       US result = 0;
-
-      for (char ch : value_match)
+      auto parsed = std::from_chars(first, last, result, base);
+      if (first == last || parsed.ec != std::errc() || parsed.ptr != last)
       {
-        US digit = 0;
-
-        if (ch >= '0' && ch <= '9')
-        {
-          digit = static_cast<US>(ch - '0');
-        }
-        else if (base == 16 && ch >= 'a' && ch <= 'f')
-        {
-          digit = static_cast<US>(ch - 'a' + 10);
-        }
-        else if (base == 16 && ch >= 'A' && ch <= 'F')
-        {
-          digit = static_cast<US>(ch - 'A' + 10);
-        }
-        else
-        {
-          throw_or_mimic<argument_incorrect_type>(text);
-        }
-
-        const US next = static_cast<US>(result * base + digit);
-        if (result > next)
-        {
-          throw_or_mimic<argument_incorrect_type>(text);
-        }
-
-        result = next;
+        throw_or_mimic<argument_incorrect_type>(std::string(text));
       }
 
       detail::check_signed_range<T>(negative, result, text);
@@ -930,6 +931,46 @@ namespace cxxopts
       }
     }
 
+#ifdef __cpp_lib_to_chars
+    // Accept what the stringstream parser accepted, leading and trailing spaces and '+' included,
+    // but the text between the spaces must be a number: "1.5abc" is rejected
+    template <typename T>
+    void
+    floating_parser(std::string_view text, T& value)
+    {
+      const char* first = text.data();
+      const char* last = first + text.size();
+      while (first != last && std::isspace(static_cast<unsigned char>(*first)))
+      {
+        ++first;
+      }
+      while (last != first && std::isspace(static_cast<unsigned char>(last[-1])))
+      {
+        --last;
+      }
+      if (first != last && *first == '+' && last - first > 1 && first[1] != '-')
+      {
+        ++first;
+      }
+      // inf and nan are read by from_chars but not by streams
+      const char* digits = first != last && *first == '-' ? first + 1 : first;
+      if (digits == last || !(std::isdigit(static_cast<unsigned char>(*digits)) || *digits == '.'))
+      {
+        throw_or_mimic<argument_incorrect_type>(std::string(text));
+      }
+      auto parsed = std::from_chars(first, last, value);
+      if (parsed.ptr != last || parsed.ec == std::errc::invalid_argument)
+      {
+        throw_or_mimic<argument_incorrect_type>(std::string(text));
+      }
+      // streams reject overflow but not underflow
+      if (parsed.ec == std::errc::result_out_of_range)
+      {
+        stringstream_parser(std::string(text), value);
+      }
+    }
+#endif
+
     template <typename T,
              typename std::enable_if<std::is_integral<T>::value>::type* = nullptr
              >
@@ -964,11 +1005,26 @@ namespace cxxopts
       value = text;
     }
 
+#ifdef __cpp_lib_to_chars
+    template <typename T,
+             typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr
+             >
+    void
+    parse_value(const std::string& text, T& value)
+    {
+      floating_parser(text, value);
+    }
+#endif
+
     // The fallback parser. It uses the stringstream parser to parse all types
     // that have not been overloaded explicitly.  It has to be placed in the
     // source code before all other more specialized templates.
     template <typename T,
-             typename std::enable_if<!std::is_integral<T>::value>::type* = nullptr
+             typename std::enable_if<!std::is_integral<T>::value
+#ifdef __cpp_lib_to_chars
+                                     && !std::is_floating_point<T>::value
+#endif
+                                     >::type* = nullptr
              >
     void
     parse_value(const std::string& text, T& value) {
@@ -985,12 +1041,19 @@ namespace cxxopts
         value.emplace_back(std::move(v));
         return;
       }
-      std::stringstream in(text);
+      // same tokens as std::getline on the delimiter: a trailing empty token is dropped
       std::string token;
-      while(!in.eof() && std::getline(in, token, CXXOPTS_VECTOR_DELIMITER)) {
+      std::size_t first = 0;
+      while (first < text.size()) {
+        std::size_t last = text.find(CXXOPTS_VECTOR_DELIMITER, first);
+        if (last == std::string::npos) {
+          last = text.size();
+        }
+        token.assign(text, first, last - first);
         T v;
         parse_value(token, v);
         value.emplace_back(std::move(v));
+        first = last + 1;
       }
     }
 
@@ -1016,6 +1079,105 @@ namespace cxxopts
       c = text[0];
     }
 
+    // Parse a value from a view in the argument, parse_value is used for the types not listed here.
+    // std::string_view values point in the argument, it must outlive them.
+    template <typename T>
+    struct is_view_parsed
+    {
+      static constexpr bool value = (std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value)
+#ifdef __cpp_lib_to_chars
+        || std::is_floating_point<T>::value
+#endif
+        ;
+    };
+
+    template <typename T,
+             typename std::enable_if<!is_view_parsed<T>::value>::type* = nullptr
+             >
+    void
+    parse_view(std::string_view text, T& value)
+    {
+      parse_value(std::string(text), value);
+    }
+
+    template <typename T,
+             typename std::enable_if<std::is_integral<T>::value && is_view_parsed<T>::value>::type* = nullptr
+             >
+    void
+    parse_view(std::string_view text, T& value)
+    {
+      integer_parser(text, value);
+    }
+
+#ifdef __cpp_lib_to_chars
+    template <typename T,
+             typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr
+             >
+    void
+    parse_view(std::string_view text, T& value)
+    {
+      floating_parser(text, value);
+    }
+#endif
+
+    inline
+    void
+    parse_view(std::string_view text, std::string& value)
+    {
+      value.assign(text);
+    }
+
+    inline
+    void
+    parse_view(std::string_view text, std::string_view& value)
+    {
+      value = text;
+    }
+
+    template <typename T>
+    void
+    parse_view(std::string_view text, std::vector<T>& value)
+    {
+      if (text.empty()) {
+        T v;
+        parse_view(text, v);
+        value.emplace_back(std::move(v));
+        return;
+      }
+      // same tokens as std::getline on the delimiter: a trailing empty token is dropped
+      std::size_t first = 0;
+      while (first < text.size()) {
+        std::size_t last = text.find(CXXOPTS_VECTOR_DELIMITER, first);
+        if (last == std::string_view::npos) {
+          last = text.size();
+        }
+        T v;
+        parse_view(text.substr(first, last - first), v);
+        value.emplace_back(std::move(v));
+        first = last + 1;
+      }
+    }
+
+#ifdef CXXOPTS_HAS_OPTIONAL
+    template <typename T>
+    void
+    parse_view(std::string_view text, std::optional<T>& value)
+    {
+      T result;
+      parse_view(text, result);
+      value = std::move(result);
+    }
+#endif
+
+    // Unique address for each type
+    template <typename T>
+    const void*
+    type_tag()
+    {
+      static const char tag = 0;
+      return &tag;
+    }
+
     template <typename T>
     struct type_is_container
     {
@@ -1050,10 +1212,15 @@ namespace cxxopts
       abstract_value& operator=(const abstract_value&) = default;
 
       abstract_value(const abstract_value& rhs)
+      : abstract_value(rhs, std::pmr::get_default_resource())
+      {
+      }
+
+      abstract_value(const abstract_value& rhs, std::pmr::memory_resource* resource)
       {
         if (rhs.m_result)
         {
-          m_result = std::make_shared<T>();
+          m_result = std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource));
           m_store = m_result.get();
         }
         else
@@ -1068,9 +1235,9 @@ namespace cxxopts
       }
 
       void
-      parse(const std::string& text) const override
+      parse(std::string_view text) const override
       {
-        parse_value(text, *m_store);
+        parse_view(text, *m_store);
       }
 
       bool
@@ -1082,7 +1249,7 @@ namespace cxxopts
       void
       parse() const override
       {
-        parse_value(m_default_value, *m_store);
+        parse_view(m_default_value, *m_store);
       }
 
       bool
@@ -1120,13 +1287,13 @@ namespace cxxopts
         return shared_from_this();
       }
 
-      std::string
+      const std::string&
       get_default_value() const override
       {
         return m_default_value;
       }
 
-      std::string
+      const std::string&
       get_implicit_value() const override
       {
         return m_implicit_value;
@@ -1171,6 +1338,20 @@ namespace cxxopts
       {
         return std::make_shared<standard_value<T>>(*this);
       }
+
+      CXXOPTS_NODISCARD
+      std::shared_ptr<Value>
+      clone(std::pmr::memory_resource* resource) const override
+      {
+        return std::allocate_shared<standard_value<T>>(
+          std::pmr::polymorphic_allocator<standard_value<T>>(resource), *this, resource);
+      }
+
+      const void*
+      type() const override
+      {
+        return type_tag<T>();
+      }
     };
 
     template <>
@@ -1190,12 +1371,32 @@ namespace cxxopts
         set_default_and_implicit();
       }
 
+      standard_value(const standard_value& rhs) = default;
+
+      standard_value(const standard_value& rhs, std::pmr::memory_resource* resource)
+      : abstract_value(rhs, resource)
+      {
+      }
+
       std::shared_ptr<Value>
       clone() const override
       {
         return std::make_shared<standard_value<bool>>(*this);
       }
 
+      std::shared_ptr<Value>
+      clone(std::pmr::memory_resource* resource) const override
+      {
+        return std::allocate_shared<standard_value<bool>>(
+          std::pmr::polymorphic_allocator<standard_value<bool>>(resource), *this, resource);
+      }
+
+      const void*
+      type() const override
+      {
+        return type_tag<bool>();
+      }
+
       private:
 
       void
@@ -1268,9 +1469,9 @@ namespace cxxopts
 
     CXXOPTS_NODISCARD
     std::shared_ptr<Value>
-    make_storage() const
+    make_storage(std::pmr::memory_resource* resource) const
     {
-      return m_value->clone();
+      return m_value->clone(resource);
     }
 
     CXXOPTS_NODISCARD
@@ -1324,35 +1525,64 @@ namespace cxxopts
     std::vector<HelpOptionDetails> options{};
   };
 
+  // Allocator aware, the parsed value is allocated from the resource of the map holding it
   class OptionValue
   {
     public:
+    using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+    OptionValue() = default;
+
+    explicit OptionValue(const allocator_type& allocator)
+    : m_resource(allocator.resource())
+    {
+    }
+
+    OptionValue(const OptionValue& rhs) = default;
+
+    OptionValue(const OptionValue& rhs, const allocator_type& allocator)
+    : OptionValue(rhs)
+    {
+      m_resource = allocator.resource();
+    }
+
+    OptionValue(OptionValue&& rhs) = default;
+
+    OptionValue(OptionValue&& rhs, const allocator_type& allocator)
+    : OptionValue(std::move(rhs))
+    {
+      m_resource = allocator.resource();
+    }
+
+    OptionValue& operator=(const OptionValue&) = default;
+    OptionValue& operator=(OptionValue&&) = default;
+
     void
     parse
     (
-      const std::shared_ptr<const OptionDetails>& details,
-      const std::string& text
+      const OptionDetails& details,
+      std::string_view text
     )
     {
       ensure_value(details);
       ++m_count;
       m_value->parse(text);
-      m_long_name = &details->long_name();
+      m_long_name = &details.long_name();
     }
 
     void
-    parse_default(const std::shared_ptr<const OptionDetails>& details)
+    parse_default(const OptionDetails& details)
     {
       ensure_value(details);
       m_default = true;
-      m_long_name = &details->long_name();
+      m_long_name = &details.long_name();
       m_value->parse();
     }
 
     void
-    parse_no_value(const std::shared_ptr<const OptionDetails>& details)
+    parse_no_value(const OptionDetails& details)
     {
-      m_long_name = &details->long_name();
+      m_long_name = &details.long_name();
     }
 
 #if defined(CXXOPTS_NULL_DEREF_IGNORE)
@@ -1388,6 +1618,11 @@ namespace cxxopts
               m_long_name == nullptr ? "" : *m_long_name);
       }
 
+      if (m_value->type() == values::type_tag<T>())
+      {
+        return static_cast<const values::standard_value<T>&>(*m_value).get();
+      }
+
 #ifdef CXXOPTS_NO_RTTI
       return static_cast<const values::standard_value<T>&>(*m_value).get();
 #else
@@ -1397,11 +1632,11 @@ namespace cxxopts
 
     private:
     void
-    ensure_value(const std::shared_ptr<const OptionDetails>& details)
+    ensure_value(const OptionDetails& details)
     {
       if (m_value == nullptr)
       {
-        m_value = details->make_storage();
+        m_value = details.make_storage(m_resource);
       }
     }
 
@@ -1410,6 +1645,7 @@ namespace cxxopts
     // Holding this pointer is safe, since OptionValue's only exist in key-value pairs,
     // where the key has the string we point to.
     std::shared_ptr<Value> m_value{};
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
     size_t m_count = 0;
     bool m_default = false;
   };
@@ -1451,8 +1687,138 @@ namespace cxxopts
     std::string m_value;
   };
 
-  using ParsedHashMap = std::unordered_map<size_t, OptionValue>;
-  using NameHashMap = std::unordered_map<std::string, size_t>;
+  // Options in struct of arrays form, the parser walks these dense arrays instead of the nodes of a
+  // name map. Names are sorted by hash and point in the option details.
+  class OptionTable
+  {
+    public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    enum Flags : std::uint8_t
+    {
+      boolean = 1 << 0,
+      container = 1 << 1,
+      has_default = 1 << 2,
+      has_implicit = 1 << 3,
+    };
+
+    explicit OptionTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    : m_details(resource)
+    , m_flags(resource)
+    , m_types(resource)
+    , m_name_hashes(resource)
+    , m_names(resource)
+    , m_name_slots(resource)
+    {
+    }
+
+    // Add an option and return its slot
+    std::size_t
+    add(const std::shared_ptr<OptionDetails>& details)
+    {
+      for (const std::string* name : {&details->short_name(), &details->long_name()})
+      {
+        if (!name->empty() && find(*name) != npos)
+        {
+          throw_or_mimic<option_exists_error>(*name);
+        }
+      }
+
+      const auto& value = details->value();
+      std::size_t slot = m_details.size();
+      m_details.push_back(details);
+      m_flags.push_back(static_cast<std::uint8_t>(
+        (value.is_boolean() ? boolean : 0) | (value.is_container() ? container : 0) |
+        (value.has_default() ? has_default : 0) | (value.has_implicit() ? has_implicit : 0)));
+      m_types.push_back(value.type());
+
+      for (const std::string* name : {&details->short_name(), &details->long_name()})
+      {
+        if (name->empty())
+        {
+          continue;
+        }
+        std::size_t hash = std::hash<std::string_view>{}(*name);
+        auto at = std::upper_bound(m_name_hashes.begin(), m_name_hashes.end(), hash) - m_name_hashes.begin();
+        m_name_hashes.insert(m_name_hashes.begin() + at, hash);
+        m_names.insert(m_names.begin() + at, *name);
+        m_name_slots.insert(m_name_slots.begin() + at, slot);
+      }
+      return slot;
+    }
+
+    // Slot of the option with this short or long name, npos if there is none
+    std::size_t
+    find(std::string_view name) const
+    {
+      std::size_t hash = std::hash<std::string_view>{}(name);
+      auto first = std::lower_bound(m_name_hashes.begin(), m_name_hashes.end(), hash);
+      for (auto at = std::size_t(first - m_name_hashes.begin()); at != m_name_hashes.size() && m_name_hashes[at] == hash; ++at)
+      {
+        if (m_names[at] == name)
+        {
+          return m_name_slots[at];
+        }
+      }
+      return npos;
+    }
+
+    std::size_t
+    size() const
+    {
+      return m_details.size();
+    }
+
+    const std::shared_ptr<OptionDetails>&
+    details(std::size_t slot) const
+    {
+      return m_details[slot];
+    }
+
+    std::uint8_t
+    flags(std::size_t slot) const
+    {
+      return m_flags[slot];
+    }
+
+    const void*
+    type(std::size_t slot) const
+    {
+      return m_types[slot];
+    }
+
+    private:
+    // one entry per option
+    std::pmr::vector<std::shared_ptr<OptionDetails>> m_details;
+    std::pmr::vector<std::uint8_t> m_flags;
+    std::pmr::vector<const void*> m_types;
+    // one entry per name
+    std::pmr::vector<std::size_t> m_name_hashes;
+    std::pmr::vector<std::string_view> m_names;
+    std::pmr::vector<std::size_t> m_name_slots;
+  };
+
+
+  // Opaque handle of an option, given by Options::handle or Options::add_option. A ParseResult of the
+  // same Options read its value by index instead of looking its name up.
+  class OptionHandle
+  {
+    public:
+    OptionHandle() = default;
+
+    private:
+    friend class Options;
+    friend class ParseResult;
+
+    OptionHandle(const OptionTable* table, std::size_t slot)
+    : m_table(table)
+    , m_slot(slot)
+    {
+    }
+
+    const OptionTable* m_table = nullptr;
+    std::size_t m_slot = OptionTable::npos;
+  };
 
   class ParseResult
   {
@@ -1515,15 +1881,17 @@ namespace cxxopts
 
       private:
       const ParseResult* m_pr;
-      std::vector<KeyValue>::const_iterator m_iter;
+      std::pmr::vector<KeyValue>::const_iterator m_iter;
     };
 
     ParseResult() = default;
     ParseResult(const ParseResult&) = default;
+    ParseResult(ParseResult&&) = default;
 
-    ParseResult(NameHashMap&& keys, ParsedHashMap&& values, std::vector<KeyValue> sequential,
-            std::vector<KeyValue> default_opts, std::vector<std::string>&& unmatched_args)
-    : m_keys(std::move(keys))
+    // Values are indexed by the slot of their option in the table
+    ParseResult(std::shared_ptr<const OptionTable> table, std::pmr::vector<OptionValue>&& values, std::pmr::vector<KeyValue> sequential,
+            std::pmr::vector<KeyValue> default_opts, std::vector<std::string>&& unmatched_args)
+    : m_table(std::move(table))
     , m_values(std::move(values))
     , m_sequential(std::move(sequential))
     , m_defaults(std::move(default_opts))
@@ -1549,43 +1917,54 @@ namespace cxxopts
     size_t
     count(const std::string& o) const
     {
-      auto iter = m_keys.find(o);
-      if (iter == m_keys.end())
-      {
-        return 0;
-      }
-
-      auto viter = m_values.find(iter->second);
-
-      if (viter == m_values.end())
+      auto slot = find(o);
+      if (slot == OptionTable::npos)
       {
         return 0;
       }
 
-      return viter->second.count();
+      return m_values[slot].count();
     }
 
     const OptionValue&
     operator[](const std::string& option) const
     {
-      auto iter = m_keys.find(option);
+      auto slot = find(option);
 
-      if (iter == m_keys.end())
+      if (slot == OptionTable::npos)
       {
         throw_or_mimic<option_not_present_exception>(option);
       }
 
-      auto viter = m_values.find(iter->second);
+      return m_values[slot];
+    }
+
+    size_t
+    count(const OptionHandle& handle) const
+    {
+      return valid(handle) ? m_values[handle.m_slot].count() : 0;
+    }
 
-      if (viter == m_values.end())
+    const OptionValue&
+    operator[](const OptionHandle& handle) const
+    {
+      if (!valid(handle))
       {
-        throw_or_mimic<option_not_present_exception>(option);
+        throw_or_mimic<option_not_present_exception>(
+          handle.m_table && handle.m_slot < handle.m_table->size() ? handle.m_table->details(handle.m_slot)->long_name() : "");
       }
 
-      return viter->second;
+      return m_values[handle.m_slot];
     }
 
-    const std::vector<KeyValue>&
+    template <typename T>
+    const T&
+    get(const OptionHandle& handle) const
+    {
+      return (*this)[handle].as<T>();
+    }
+
+    const std::pmr::vector<KeyValue>&
     arguments() const
     {
       return m_sequential;
@@ -1597,7 +1976,7 @@ namespace cxxopts
       return m_unmatched;
     }
 
-    const std::vector<KeyValue>&
+    const std::pmr::vector<KeyValue>&
     defaults() const
     {
       return m_defaults;
@@ -1619,10 +1998,28 @@ namespace cxxopts
     }
 
     private:
-    NameHashMap m_keys{};
-    ParsedHashMap m_values{};
-    std::vector<KeyValue> m_sequential{};
-    std::vector<KeyValue> m_defaults{};
+    bool
+    valid(const OptionHandle& handle) const
+    {
+      return handle.m_table == m_table.get() && handle.m_slot < m_values.size();
+    }
+
+    std::size_t
+    find(std::string_view option) const
+    {
+      if (m_table == nullptr)
+      {
+        return OptionTable::npos;
+      }
+      // options added after the parse have no value
+      auto slot = m_table->find(option);
+      return slot < m_values.size() ? slot : OptionTable::npos;
+    }
+
+    std::shared_ptr<const OptionTable> m_table{};
+    std::pmr::vector<OptionValue> m_values{};
+    std::pmr::vector<KeyValue> m_sequential{};
+    std::pmr::vector<KeyValue> m_defaults{};
     std::vector<std::string> m_unmatched{};
   };
 
@@ -1648,17 +2045,22 @@ namespace cxxopts
     std::string arg_help_;
   };
 
-  using OptionMap = std::unordered_map<std::string, std::shared_ptr<OptionDetails>>;
   using PositionalList = std::vector<std::string>;
   using PositionalListIterator = PositionalList::const_iterator;
 
   class OptionParser
   {
     public:
-    OptionParser(const OptionMap& options, const PositionalList& positional, bool allow_unrecognised)
-    : m_options(options)
+    OptionParser(const std::shared_ptr<const OptionTable>& options, const PositionalList& positional, bool allow_unrecognised, bool view_arguments = false,
+                 std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+    : m_table(options)
+    , m_options(*options)
     , m_positional(positional)
+    , m_sequential(resource)
+    , m_defaults(resource)
     , m_allow_unrecognised(allow_unrecognised)
+    , m_view_arguments(view_arguments)
+    , m_parsed(m_options.size(), resource)
     {
     }
 
@@ -1666,7 +2068,7 @@ namespace cxxopts
     parse(int argc, const char* const* argv);
 
     bool
-    consume_positional(const std::string& a, PositionalListIterator& next);
+    consume_positional(std::string_view a, PositionalListIterator& next);
 
     void
     checked_parse_arg
@@ -1674,56 +2076,62 @@ namespace cxxopts
       int argc,
       const char* const* argv,
       int& current,
-      const std::shared_ptr<OptionDetails>& value,
+      std::size_t slot,
       const std::string& name
     );
 
     void
-    add_to_option(OptionMap::const_iterator iter, const std::string& option, const std::string& arg);
+    add_to_option(std::size_t slot, const std::string& option, std::string_view arg);
 
     void
     parse_option
     (
-      const std::shared_ptr<OptionDetails>& value,
+      std::size_t slot,
       const std::string& name,
-      const std::string& arg = ""
+      std::string_view arg = ""
     );
 
     void
-    parse_default(const std::shared_ptr<OptionDetails>& details);
+    parse_default(std::size_t slot);
 
     void
-    parse_no_value(const std::shared_ptr<OptionDetails>& details);
+    parse_no_value(std::size_t slot);
 
     private:
 
-    void finalise_aliases();
-
-    const OptionMap& m_options;
+    std::shared_ptr<const OptionTable> m_table;
+    const OptionTable& m_options;
     const PositionalList& m_positional;
 
-    std::vector<KeyValue> m_sequential{};
-    std::vector<KeyValue> m_defaults{};
+    std::pmr::vector<KeyValue> m_sequential;
+    std::pmr::vector<KeyValue> m_defaults;
     bool m_allow_unrecognised;
+    bool m_view_arguments;
 
-    ParsedHashMap m_parsed{};
-    NameHashMap m_keys{};
+    std::pmr::vector<OptionValue> m_parsed;
   };
 
   class Options
   {
     public:
 
-    explicit Options(std::string program, std::string help_string = "")
+    // Options are allocated from resource, it must outlive them. Parse results are allocated from
+    // the resource given to parse, the default resource otherwise
+    explicit Options(std::string program, std::string help_string = "",
+                     std::pmr::memory_resource* resource = std::pmr::get_default_resource())
     : m_program(std::move(program))
     , m_help_string(toLocalString(std::move(help_string)))
     , m_custom_help("[OPTION...]")
     , m_positional_help("positional parameters")
     , m_show_positional(false)
     , m_allow_unrecognised(false)
+    , m_view_arguments(false)
     , m_width(76)
     , m_tab_expansion(false)
-    , m_options(std::make_shared<OptionMap>())
+    , m_resource(resource)
+    , m_options(std::allocate_shared<OptionTable>(std::pmr::polymorphic_allocator<OptionTable>(resource), resource))
+    , m_positional_set(resource)
+    , m_help(resource)
     {
     }
 
@@ -1734,6 +2142,18 @@ namespace cxxopts
       return *this;
     }
 
+    const std::string&
+    positional_help_text() const
+    {
+      return m_positional_help;
+    }
+
+    const std::vector<std::string>&
+    positional_options() const
+    {
+      return m_positional;
+    }
+
     Options&
     custom_help(std::string help_text)
     {
@@ -1755,6 +2175,15 @@ namespace cxxopts
       return *this;
     }
 
+    // Parse without copying arguments: std::string_view values point in argv, or in the option
+    // declaration for default and implicit values, and arguments() is left empty
+    Options&
+    view_arguments(bool view = true)
+    {
+      m_view_arguments = view;
+      return *this;
+    }
+
     Options&
     set_width(size_t width)
     {
@@ -1769,8 +2198,13 @@ namespace cxxopts
       return *this;
     }
 
+    // Options are only read, parse can be called from several threads at the same time
     ParseResult
-    parse(int argc, const char* const* argv);
+    parse(int argc, const char* const* argv) const;
+
+    // Parse with the result allocated from resource, it must outlive the result
+    ParseResult
+    parse(int argc, const char* const* argv, std::pmr::memory_resource* resource) const;
 
     OptionAdder
     add_options(std::string group = "");
@@ -1782,14 +2216,14 @@ namespace cxxopts
       std::initializer_list<Option> options
     );
 
-    void
+    OptionHandle
     add_option
     (
       const std::string& group,
       const Option& option
     );
 
-    void
+    OptionHandle
     add_option
     (
       const std::string& group,
@@ -1800,6 +2234,10 @@ namespace cxxopts
       std::string arg_help
     );
 
+    // Handle of the option with this short or long name, read parse results without lookup
+    OptionHandle
+    handle(const std::string& name) const;
+
     //parse positional arguments into the given option
     void
     parse_positional(std::string option);
@@ -1819,6 +2257,10 @@ namespace cxxopts
     std::string
     help(const std::vector<std::string>& groups = {}) const;
 
+    // Help wrapped to width columns instead of the width of the options
+    std::string
+    help(const std::vector<std::string>& groups, size_t width) const;
+
     std::vector<std::string>
     groups() const;
 
@@ -1827,25 +2269,19 @@ namespace cxxopts
 
     private:
 
-    void
-    add_one_option
-    (
-      const std::string& option,
-      const std::shared_ptr<OptionDetails>& details
-    );
-
     String
-    help_one_group(const std::string& group) const;
+    help_one_group(const std::string& group, size_t width) const;
 
     void
     generate_group_help
     (
       String& result,
-      const std::vector<std::string>& groups
+      const std::vector<std::string>& groups,
+      size_t width
     ) const;
 
     void
-    generate_all_groups_help(String& result) const;
+    generate_all_groups_help(String& result, size_t width) const;
 
     std::string m_program{};
     String m_help_string{};
@@ -1853,18 +2289,17 @@ namespace cxxopts
     std::string m_positional_help{};
     bool m_show_positional;
     bool m_allow_unrecognised;
+    bool m_view_arguments;
     size_t m_width;
     bool m_tab_expansion;
+    std::pmr::memory_resource* m_resource;
 
-    std::shared_ptr<OptionMap> m_options;
+    std::shared_ptr<OptionTable> m_options;
     std::vector<std::string> m_positional{};
-    std::unordered_set<std::string> m_positional_set{};
+    std::pmr::unordered_set<std::string> m_positional_set;
 
     //mapping from groups to help options
-    std::map<std::string, HelpGroupDetails> m_help{};
-
-    std::list<OptionDetails> m_option_list{};
-    std::unordered_map<std::string, decltype(m_option_list)::iterator> m_option_map{};
+    std::pmr::map<std::string, HelpGroupDetails> m_help;
   };
 
   class OptionAdder
@@ -2145,36 +2580,40 @@ OptionAdder::operator()
 
 inline
 void
-OptionParser::parse_default(const std::shared_ptr<OptionDetails>& details)
+OptionParser::parse_default(std::size_t slot)
 {
   // TODO: remove the duplicate code here
-  auto& store = m_parsed[details->hash()];
-  store.parse_default(details);
-  m_defaults.emplace_back(details->long_name(), details->value().get_default_value());
+  const auto& details = *m_options.details(slot);
+  m_parsed[slot].parse_default(details);
+  if (!m_view_arguments)
+  {
+    m_defaults.emplace_back(details.long_name(), details.value().get_default_value());
+  }
 }
 
 inline
 void
-OptionParser::parse_no_value(const std::shared_ptr<OptionDetails>& details)
+OptionParser::parse_no_value(std::size_t slot)
 {
-  auto& store = m_parsed[details->hash()];
-  store.parse_no_value(details);
+  m_parsed[slot].parse_no_value(*m_options.details(slot));
 }
 
 inline
 void
 OptionParser::parse_option
 (
-  const std::shared_ptr<OptionDetails>& value,
+  std::size_t slot,
   const std::string& /*name*/,
-  const std::string& arg
+  std::string_view arg
 )
 {
-  auto hash = value->hash();
-  auto& result = m_parsed[hash];
-  result.parse(value, arg);
+  const auto& value = *m_options.details(slot);
+  m_parsed[slot].parse(value, arg);
 
-  m_sequential.emplace_back(value->long_name(), arg);
+  if (!m_view_arguments)
+  {
+    m_sequential.emplace_back(value.long_name(), std::string(arg));
+  }
 }
 
 inline
@@ -2184,64 +2623,53 @@ OptionParser::checked_parse_arg
   int argc,
   const char* const* argv,
   int& current,
-  const std::shared_ptr<OptionDetails>& value,
+  std::size_t slot,
   const std::string& name
 )
 {
-  if (current + 1 >= argc)
+  if (m_options.flags(slot) & OptionTable::has_implicit)
   {
-    if (value->value().has_implicit())
-    {
-      parse_option(value, name, value->value().get_implicit_value());
-    }
-    else
-    {
-      throw_or_mimic<missing_argument_exception>(name);
-    }
+    parse_option(slot, name, m_options.details(slot)->value().get_implicit_value());
+  }
+  else if (current + 1 >= argc)
+  {
+    throw_or_mimic<missing_argument_exception>(name);
   }
   else
   {
-    if (value->value().has_implicit())
-    {
-      parse_option(value, name, value->value().get_implicit_value());
-    }
-    else
-    {
-      parse_option(value, name, argv[current + 1]);
-      ++current;
-    }
+    parse_option(slot, name, argv[current + 1]);
+    ++current;
   }
 }
 
 inline
 void
-OptionParser::add_to_option(OptionMap::const_iterator iter, const std::string& option, const std::string& arg)
+OptionParser::add_to_option(std::size_t slot, const std::string& option, std::string_view arg)
 {
-  parse_option(iter->second, option, arg);
+  parse_option(slot, option, arg);
 }
 
 inline
 bool
-OptionParser::consume_positional(const std::string& a, PositionalListIterator& next)
+OptionParser::consume_positional(std::string_view a, PositionalListIterator& next)
 {
   while (next != m_positional.end())
   {
-    auto iter = m_options.find(*next);
-    if (iter != m_options.end())
+    auto slot = m_options.find(*next);
+    if (slot != OptionTable::npos)
     {
-      if (!iter->second->value().is_container())
+      if (!(m_options.flags(slot) & OptionTable::container))
       {
-        auto& result = m_parsed[iter->second->hash()];
-        if (result.count() == 0)
+        if (m_parsed[slot].count() == 0)
         {
-          add_to_option(iter, *next, a);
+          add_to_option(slot, *next, a);
           ++next;
           return true;
         }
         ++next;
         continue;
       }
-      add_to_option(iter, *next, a);
+      add_to_option(slot, *next, a);
       return true;
     }
     throw_or_mimic<option_not_exists_exception>(*next);
@@ -2275,9 +2703,15 @@ Options::parse_positional(std::initializer_list<std::string> options)
 
 inline
 ParseResult
-Options::parse(int argc, const char* const* argv)
+Options::parse(int argc, const char* const* argv) const
+{
+  return parse(argc, argv, std::pmr::get_default_resource());
+}
+
+inline ParseResult
+Options::parse(int argc, const char* const* argv, std::pmr::memory_resource* resource) const
 {
-  OptionParser parser(*m_options, m_positional, m_allow_unrecognised);
+  OptionParser parser(m_options, m_positional, m_allow_unrecognised, m_view_arguments, resource);
 
   return parser.parse(argc, argv);
 }
@@ -2330,14 +2764,14 @@ OptionParser::parse(int argc, const char* const* argv)
       //short or long option?
       if (argu_desc.grouping)
       {
-        const std::string& s = argu_desc.arg_name;
+        std::string_view s = argu_desc.arg_name;
 
         for (std::size_t i = 0; i != s.size(); ++i)
         {
           std::string name(1, s[i]);
-          auto iter = m_options.find(name);
+          auto slot = m_options.find(name);
 
-          if (iter == m_options.end())
+          if (slot == OptionTable::npos)
           {
             if (m_allow_unrecognised)
             {
@@ -2348,21 +2782,18 @@ OptionParser::parse(int argc, const char* const* argv)
             throw_or_mimic<option_not_exists_exception>(name);
           }
 
-          auto value = iter->second;
-
           if (i + 1 == s.size())
           {
             //it must be the last argument
-            checked_parse_arg(argc, argv, current, value, name);
+            checked_parse_arg(argc, argv, current, slot, name);
           }
-          else if (value->value().has_implicit())
+          else if (m_options.flags(slot) & OptionTable::has_implicit)
           {
-            parse_option(value, name, value->value().get_implicit_value());
+            parse_option(slot, name, m_options.details(slot)->value().get_implicit_value());
           }
           else if (i + 1 < s.size())
           {
-            std::string arg_value = s.substr(i + 1);
-            parse_option(value, name, arg_value);
+            parse_option(slot, name, s.substr(i + 1));
             break;
           }
           else
@@ -2374,11 +2805,11 @@ OptionParser::parse(int argc, const char* const* argv)
       }
       else if (argu_desc.arg_name.length() != 0)
       {
-        const std::string& name = argu_desc.arg_name;
+        const std::string name(argu_desc.arg_name);
 
-        auto iter = m_options.find(name);
+        auto slot = m_options.find(name);
 
-        if (iter == m_options.end())
+        if (slot == OptionTable::npos)
         {
           if (m_allow_unrecognised)
           {
@@ -2391,19 +2822,17 @@ OptionParser::parse(int argc, const char* const* argv)
           throw_or_mimic<option_not_exists_exception>(name);
         }
 
-        auto opt = iter->second;
-
         //equals provided for long option?
         if (argu_desc.set_value)
         {
           //parse the option given
 
-          parse_option(opt, name, argu_desc.value);
+          parse_option(slot, name, argu_desc.value);
         }
         else
         {
           //parse the next argument
-          checked_parse_arg(argc, argv, current, opt, name);
+          checked_parse_arg(argc, argv, current, slot, name);
         }
       }
 
@@ -2412,20 +2841,17 @@ OptionParser::parse(int argc, const char* const* argv)
     ++current;
   }
 
-  for (auto& opt : m_options)
+  for (std::size_t slot = 0; slot != m_options.size(); ++slot)
   {
-    auto& detail = opt.second;
-    const auto& value = detail->value();
-
-    auto& store = m_parsed[detail->hash()];
+    auto& store = m_parsed[slot];
 
-    if (value.has_default()) {
+    if (m_options.flags(slot) & OptionTable::has_default) {
       if (!store.count() && !store.has_default()) {
-        parse_default(detail);
+        parse_default(slot);
       }
     }
     else {
-      parse_no_value(detail);
+      parse_no_value(slot);
     }
   }
 
@@ -2446,29 +2872,12 @@ OptionParser::parse(int argc, const char* const* argv)
     }
   }
 
-  finalise_aliases();
-
-  ParseResult parsed(std::move(m_keys), std::move(m_parsed), std::move(m_sequential), std::move(m_defaults), std::move(unmatched));
+  ParseResult parsed(m_table, std::move(m_parsed), std::move(m_sequential), std::move(m_defaults), std::move(unmatched));
   return parsed;
 }
 
 inline
-void
-OptionParser::finalise_aliases()
-{
-  for (auto& option: m_options)
-  {
-    auto& detail = *option.second;
-    auto hash = detail.hash();
-    m_keys[detail.short_name()] = hash;
-    m_keys[detail.long_name()] = hash;
-
-    m_parsed.emplace(hash, OptionValue());
-  }
-}
-
-inline
-void
+OptionHandle
 Options::add_option
 (
   const std::string& group,
@@ -2476,10 +2885,23 @@ Options::add_option
 )
 {
     add_options(group, {option});
+    return OptionHandle(m_options.get(), m_options->size() - 1);
 }
 
 inline
-void
+OptionHandle
+Options::handle(const std::string& name) const
+{
+  auto slot = m_options->find(name);
+  if (slot == OptionTable::npos)
+  {
+    throw_or_mimic<option_not_exists_exception>(name);
+  }
+  return OptionHandle(m_options.get(), slot);
+}
+
+inline
+OptionHandle
 Options::add_option
 (
   const std::string& group,
@@ -2491,22 +2913,9 @@ Options::add_option
 )
 {
   auto stringDesc = toLocalString(std::move(desc));
-  auto option = std::make_shared<OptionDetails>(s, l, stringDesc, value);
-
-  if (!s.empty())
-  {
-    add_one_option(s, option);
-  }
+  auto option = std::allocate_shared<OptionDetails>(std::pmr::polymorphic_allocator<OptionDetails>(m_resource), s, l, stringDesc, value);
 
-  if (!l.empty())
-  {
-    add_one_option(l, option);
-  }
-
-  m_option_list.push_front(*option.get());
-  auto iter = m_option_list.begin();
-  m_option_map[s] = iter;
-  m_option_map[l] = iter;
+  auto slot = m_options->add(option);
 
   //add the help details
   auto& options = m_help[group];
@@ -2517,27 +2926,13 @@ Options::add_option
       std::move(arg_help),
       value->is_container(),
       value->is_boolean()});
-}
 
-inline
-void
-Options::add_one_option
-(
-  const std::string& option,
-  const std::shared_ptr<OptionDetails>& details
-)
-{
-  auto in = m_options->emplace(option, details);
-
-  if (!in.second)
-  {
-    throw_or_mimic<option_exists_error>(option);
-  }
+  return OptionHandle(m_options.get(), slot);
 }
 
 inline
 String
-Options::help_one_group(const std::string& g) const
+Options::help_one_group(const std::string& g, size_t width) const
 {
   using OptionHelp = std::vector<std::pair<String, String>>;
 
@@ -2574,9 +2969,9 @@ Options::help_one_group(const std::string& g) const
 
   //widest allowed description -- min 10 chars for helptext/line
   size_t allowed = 10;
-  if (m_width > allowed + longest + OPTION_DESC_GAP)
+  if (width > allowed + longest + OPTION_DESC_GAP)
   {
-    allowed = m_width - longest - OPTION_DESC_GAP;
+    allowed = width - longest - OPTION_DESC_GAP;
   }
 
   auto fiter = format.begin();
@@ -2616,12 +3011,13 @@ void
 Options::generate_group_help
 (
   String& result,
-  const std::vector<std::string>& print_groups
+  const std::vector<std::string>& print_groups,
+  size_t width
 ) const
 {
   for (size_t i = 0; i != print_groups.size(); ++i)
   {
-    const String& group_help_text = help_one_group(print_groups[i]);
+    const String& group_help_text = help_one_group(print_groups[i], width);
     if (empty(group_help_text))
     {
       continue;
@@ -2636,7 +3032,7 @@ Options::generate_group_help
 
 inline
 void
-Options::generate_all_groups_help(String& result) const
+Options::generate_all_groups_help(String& result, size_t width) const
 {
   std::vector<std::string> all_groups;
 
@@ -2650,12 +3046,19 @@ Options::generate_all_groups_help(String& result) const
     }
   );
 
-  generate_group_help(result, all_groups);
+  generate_group_help(result, all_groups, width);
 }
 
 inline
 std::string
 Options::help(const std::vector<std::string>& help_groups) const
+{
+  return help(help_groups, m_width);
+}
+
+inline
+std::string
+Options::help(const std::vector<std::string>& help_groups, size_t width) const
 {
   String result = m_help_string + "\nUsage:\n  " +
     toLocalString(m_program) + " " + toLocalString(m_custom_help);
@@ -2668,11 +3071,11 @@ Options::help(const std::vector<std::string>& help_groups) const
 
   if (help_groups.empty())
   {
-    generate_all_groups_help(result);
+    generate_all_groups_help(result, width);
   }
   else
   {
-    generate_group_help(result, help_groups);
+    generate_group_help(result, help_groups, width);
   }
 
   return toUTF8String(result);
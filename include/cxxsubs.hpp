@@ -12,20 +12,611 @@
 
 #pragma once
 
+// cxxopts parse arguments with its hand-written tokenizer, define CXXSUBS_REGEX to use std::regex
+#if !defined(CXXSUBS_REGEX) && !defined(CXXOPTS_NO_REGEX)
+#define CXXOPTS_NO_REGEX
+#endif
 #include "cxxopts.hpp"
-#include <iomanip>
-#include <regex>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
 
 namespace cxxsubs {
 
+//! Compile time declaration of a verb.
+//!
+//! An options class exposing it as `static constexpr cxxsubs::Verb<N> verb` is only
+//! constructed by cxxsubs::Verbs when its verb match the command line.
+//!
+//! \tparam Depth  Number of words in the verb path
+//!
+template <std::size_t Depth>
+struct Verb {
+  std::array<std::string_view, Depth> path;
+  std::string_view description;
+};
+
+//! Buffered output of a dispatch, validate and exec write in it with `this->out()`.
+//!
+//! It's written to its target when its buffer is full or when it's flushed, dispatchers flush it
+//! once at the end of the dispatch. A text larger than the free space of the buffer is written at
+//! once right after the buffer content. Lines should end with '\n', `std::endl` flush at each line,
+//! and what is written straight to std::cout may come before what is still buffered.
+//!
+class Output : public std::ostream {
+public:
+  //! Write in the stream buffer std::cout has when the output is constructed
+  Output()
+      : Output(std::cout.rdbuf()) {
+    this->fd = 1;
+  }
+  //! Write in a stream buffer, it must outlive the output
+  explicit Output(std::streambuf *target)
+      : std::ostream(nullptr), buffer(target, nullptr, -1) {
+    this->rdbuf(&this->buffer);
+  }
+  //! Append to a string, it must outlive the output
+  explicit Output(std::string &target)
+      : std::ostream(nullptr), buffer(nullptr, &target, -1) {
+    this->rdbuf(&this->buffer);
+  }
+  //! Write to a file descriptor, it's not closed
+  explicit Output(int fd)
+      : std::ostream(nullptr), buffer(nullptr, nullptr, fd), fd(fd) {
+    this->rdbuf(&this->buffer);
+  }
+  ~Output() {
+    this->flush();
+  }
+  Output(const Output &) = delete;
+  Output &operator=(const Output &) = delete;
+
+  //! File descriptor the output end up in, stdout for std::cout, -1 when unknown (string, stream buffer)
+  int descriptor() const {
+    return this->fd;
+  }
+
+private:
+  //! Stream buffer writing its content to the target of the output
+  class sink : public std::streambuf {
+  public:
+    sink(std::streambuf *stream, std::string *text, int fd)
+        : stream(stream), text(text), fd(fd) {
+      this->setp(this->buffer, this->buffer + sizeof(this->buffer));
+    }
+
+  protected:
+    int_type overflow(int_type ch) override {
+      if (!this->write()) {
+        return traits_type::eof();
+      }
+      if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *this->pptr() = traits_type::to_char_type(ch);
+        this->pbump(1);
+      }
+      return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+      if (!this->write()) {
+        return -1;
+      }
+      return this->stream && this->stream->pubsync() != 0 ? -1 : 0;
+    }
+
+    //! Copy in the buffer when it fit, otherwise write the buffer content then the text at once
+    std::streamsize xsputn(const char *data, std::streamsize count) override {
+      if (count <= this->epptr() - this->pptr()) {
+        std::memcpy(this->pptr(), data, std::size_t(count));
+        this->pbump(int(count));
+        return count;
+      }
+      if (!this->write() || !this->write(data, std::size_t(count))) {
+        return 0;
+      }
+      return count;
+    }
+
+  private:
+    //! Write the buffer content to the target, the buffer is empty afterward
+    bool write() {
+      std::size_t size = std::size_t(this->pptr() - this->pbase());
+      this->setp(this->buffer, this->buffer + sizeof(this->buffer));
+      return size == 0 || this->write(this->buffer, size);
+    }
+
+    //! Write a text to the target
+    bool write(const char *data, std::size_t size) {
+      if (this->stream) {
+        return this->stream->sputn(data, std::streamsize(size)) == std::streamsize(size);
+      }
+      if (this->text) {
+        this->text->append(data, size);
+        return true;
+      }
+      while (size > 0) {
+#ifdef _WIN32
+        int written = ::_write(this->fd, data, unsigned(size));
+#else
+        ssize_t written = ::write(this->fd, data, size);
+#endif
+        if (written < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          return false;
+        }
+        data += written;
+        size -= std::size_t(written);
+      }
+      return true;
+    }
+
+    std::streambuf *stream;
+    std::string *text;
+    int fd;
+    char buffer[4096];
+  };
+
+  sink buffer;
+  int fd = -1;
+};
+
+//! State of one dispatch, handed to validate and exec of options that support concurrent dispatch
+struct Context {
+  const cxxopts::ParseResult &result;
+  //! Output of the dispatch
+  Output &output;
+};
+
+//! Dispatch a command line, handed to built-in commands that run other verbs
+using DispatchFunction = std::function<int(int argc, const char * const *argv)>;
+
+//! Get the possible values of an option for its completion
+using ValuesFunction = std::function<std::vector<std::string>()>;
+
+namespace utils {
+
+//! Write a file aside then rename it, so a concurrent reader never see a partial file
+//!
+//! \return Error of the write or the rename, the file is left untouched on error
+//!
+inline std::error_code write_file(const std::filesystem::path &file, const std::function<void(std::ostream &)> &write) {
+  std::error_code error;
+  std::filesystem::create_directories(file.parent_path(), error);
+  std::filesystem::path temporary = file;
+  temporary += ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+  {
+    std::ofstream output(temporary);
+    write(output);
+    if (!output.flush()) {
+      output.close();
+      std::filesystem::remove(temporary, error);
+      return std::make_error_code(std::errc::io_error);
+    }
+  }
+  std::filesystem::rename(temporary, file, error);
+  if (error) {
+    std::error_code ignored;
+    std::filesystem::remove(temporary, ignored);
+  }
+  return error;
+}
+
+} // namespace utils
+
+//! Values of an option computed by a callback, kept for a time and computed within a time budget.
+//!
+//! The values are kept in memory and in a cache file shared by the processes, so the shell
+//! completion that start a process at each TAB find them until they expire. The callback run in a
+//! detached child process that write the cache file: when it exceed the budget the completion give
+//! up or use the expired values and never wait for it, the next completion read the values it
+//! stored. On Windows the callback is called in place without budget.
+//!
+class ValuesCompleter {
+public:
+  ValuesCompleter(ValuesFunction function, std::chrono::milliseconds ttl, std::chrono::milliseconds budget)
+      : function(std::move(function)), ttl(ttl), budget(budget) {
+  }
+  ~ValuesCompleter() {
+#ifndef _WIN32
+    // the child keep running and store its values, it's not waited for
+    if (this->pending >= 0) {
+      ::close(this->pending);
+    }
+#endif
+  }
+  ValuesCompleter(const ValuesCompleter &) = delete;
+  ValuesCompleter &operator=(const ValuesCompleter &) = delete;
+
+  //! Values starting with prefix, none if the callback exceed the budget without previous values
+  //!
+  //! \param file  Cache file of the values, empty to keep them in memory only
+  //!
+  std::vector<std::string> values(const std::string &prefix, const std::filesystem::path &file) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->computed || std::chrono::steady_clock::now() >= this->expire) {
+      this->load(file);
+    }
+    if (!this->computed || std::chrono::steady_clock::now() >= this->expire) {
+      // expired values are still used when the callback exceed the budget
+      this->refresh(file);
+    }
+    std::vector<std::string> result;
+    for (const std::string &value : this->cache) {
+      if (value.compare(0, prefix.size(), prefix) == 0) {
+        result.push_back(value);
+      }
+    }
+    return result;
+  }
+
+private:
+  //! Read the values of the cache file when they expire after the ones in memory
+  //!
+  //! The first line is the expiration time in milliseconds since the system clock epoch, then one
+  //! value per line.
+  void load(const std::filesystem::path &file) {
+    std::ifstream input;
+    if (!file.empty()) {
+      input.open(file);
+    }
+    long long expiration = 0;
+    if (!input || !(input >> expiration) || input.get() != '\n') {
+      return;
+    }
+    auto remaining = std::chrono::milliseconds(expiration) - std::chrono::system_clock::now().time_since_epoch();
+    auto expire = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(remaining);
+    if (this->computed && expire <= this->expire) {
+      return;
+    }
+    std::vector<std::string> values;
+    for (std::string value; std::getline(input, value);) {
+      values.push_back(std::move(value));
+    }
+    this->set(std::move(values), expire);
+  }
+
+  //! Write the values in the cache file
+  static void store(const std::filesystem::path &file, const std::vector<std::string> &values, std::chrono::milliseconds ttl) {
+    if (file.empty()) {
+      return;
+    }
+    utils::write_file(file, [&values, ttl](std::ostream &output) {
+      auto expiration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch() + ttl);
+      output << expiration.count() << "\n";
+      for (const std::string &value : values) {
+        output << value << "\n";
+      }
+    });
+  }
+
+  void set(std::vector<std::string> values, std::chrono::steady_clock::time_point expire) {
+    this->cache = std::move(values);
+    this->expire = expire;
+    this->computed = true;
+  }
+
+#ifndef _WIN32
+  //! Wait at most the budget for the values of the child computing them, one is started if needed
+  void refresh(const std::filesystem::path &file) {
+    if (this->pending < 0) {
+      this->pending = this->start(file);
+      this->received.clear();
+    }
+    auto deadline = std::chrono::steady_clock::now() + this->budget;
+    while (this->pending >= 0) {
+      auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+      pollfd request{this->pending, POLLIN, 0};
+      int ready = ::poll(&request, 1, remaining.count() > 0 ? int(remaining.count()) : 0);
+      if (ready < 0 && errno == EINTR) {
+        continue;
+      }
+      if (ready <= 0) {
+        // the child is left running, a later call read what it send
+        return;
+      }
+      char buffer[4096];
+      ssize_t size = ::read(this->pending, buffer, sizeof(buffer));
+      if (size < 0 && errno == EINTR) {
+        continue;
+      }
+      if (size > 0) {
+        this->received.append(buffer, std::size_t(size));
+        continue;
+      }
+      ::close(this->pending);
+      this->pending = -1;
+      // the values follow a '+' sent once the callback returned, nothing is sent if it throw
+      if (size == 0 && !this->received.empty() && this->received[0] == '+') {
+        std::vector<std::string> values;
+        std::size_t begin = 1;
+        for (std::size_t end; (end = this->received.find('\n', begin)) != std::string::npos; begin = end + 1) {
+          values.push_back(this->received.substr(begin, end - begin));
+        }
+        this->set(std::move(values), std::chrono::steady_clock::now() + this->ttl);
+      }
+      this->received.clear();
+    }
+  }
+
+  //! Call the callback in a detached child that store the values and send them on a pipe
+  //!
+  //! \return Read end of the pipe, -1 if the child can't be started
+  //!
+  int start(const std::filesystem::path &file) {
+    int fds[2];
+    if (::pipe(fds) != 0) {
+      return -1;
+    }
+    pid_t child = ::fork();
+    if (child < 0) {
+      ::close(fds[0]);
+      ::close(fds[1]);
+      return -1;
+    }
+    if (child == 0) {
+      ::close(fds[0]);
+      // the grandchild is orphaned, nobody has to wait for it
+      if (::fork() != 0) {
+        ::_exit(0);
+      }
+      // the shell read the completion output until every process holding it exit
+      int null = ::open("/dev/null", O_RDWR);
+      if (null >= 0) {
+        ::dup2(null, STDIN_FILENO);
+        ::dup2(null, STDOUT_FILENO);
+        ::dup2(null, STDERR_FILENO);
+        ::close(null);
+      }
+      std::signal(SIGPIPE, SIG_IGN);
+      try {
+        std::vector<std::string> values = this->function();
+        store(file, values, this->ttl);
+        std::string text = "+";
+        for (const std::string &value : values) {
+          text += value + "\n";
+        }
+        for (std::size_t sent = 0; sent < text.size();) {
+          ssize_t size = ::write(fds[1], text.data() + sent, text.size() - sent);
+          if (size < 0 && errno == EINTR) {
+            continue;
+          }
+          if (size <= 0) {
+            break;
+          }
+          sent += std::size_t(size);
+        }
+      } catch (...) {
+      }
+      ::_exit(0);
+    }
+    ::close(fds[1]);
+    ::waitpid(child, nullptr, 0);
+    return fds[0];
+  }
+#else
+  void refresh(const std::filesystem::path &file) {
+    try {
+      std::vector<std::string> values = this->function();
+      store(file, values, this->ttl);
+      this->set(std::move(values), std::chrono::steady_clock::now() + this->ttl);
+    } catch (...) {
+    }
+  }
+#endif
+
+  ValuesFunction function;
+  std::chrono::milliseconds ttl;
+  std::chrono::milliseconds budget;
+
+  std::mutex mutex;
+  std::vector<std::string> cache;
+  std::chrono::steady_clock::time_point expire;
+  bool computed = false;
+  //! Read end of the pipe of the child computing the values, -1 if none
+  int pending = -1;
+  //! What the child sent so far
+  std::string received;
+};
+
+//! Option of a verb as listed in completion scripts
+struct OptionEntry {
+  std::string short_name;
+  std::string long_name;
+  std::string description;
+  std::string arg_help;
+  bool is_boolean;
+  bool is_container;
+  //! Set when the option values are completed by a callback
+  std::shared_ptr<ValuesCompleter> values;
+};
+
+//! Options and positional arguments of a verb as listed in completion scripts
+struct VerbOptions {
+  std::vector<OptionEntry> options;
+  //! Hint of each positional argument, taken from positional_help
+  std::vector<std::string> positional;
+  //! Name of the option filled by each positional argument
+  std::vector<std::string> positional_options;
+  //! Last positional argument take all remaining words
+  bool positional_rest;
+};
+
+//! Get the options of the verb at the given index in the verb table, valid as long as the dispatcher
+using OptionsFunction = std::function<const VerbOptions &(std::size_t index)>;
+
+class IOptions; // Early declaration
+
 namespace utils {
 
+//! Check if an options class declare its verb statically
+template <typename T, typename = void>
+struct has_static_verb : std::false_type {};
+
+template <typename T>
+struct has_static_verb<T, std::void_t<decltype(T::verb)>> : std::true_type {};
+
+//! Class declaring the exec found in an options class, cxxsubs::IOptions when it's only inherited
+template <typename Class>
+Class exec_class(int (Class::*)());
+
+template <typename Class>
+Class concurrent_exec_class(int (Class::*)(const Context &) const);
+
+template <typename Class>
+Class validate_class(int (Class::*)());
+
+//! Check if an options class implement exec
+template <typename T, typename = void>
+struct has_exec : std::false_type {};
+
+template <typename T>
+struct has_exec<T, std::void_t<decltype(exec_class(&T::exec))>> : std::negation<std::is_same<decltype(exec_class(&T::exec)), IOptions>> {};
+
+//! Check if an options class implement validate without Context
+template <typename T, typename = void>
+struct has_validate : std::false_type {};
+
+template <typename T>
+struct has_validate<T, std::void_t<decltype(validate_class(&T::validate))>> : std::negation<std::is_same<decltype(validate_class(&T::validate)), IOptions>> {};
+
+//! Check if an options class implement validate and exec with a per dispatch Context
+template <typename T, typename = void>
+struct is_concurrent : std::false_type {};
+
+template <typename T>
+struct is_concurrent<T, std::void_t<decltype(concurrent_exec_class(&T::exec))>> : std::negation<std::is_same<decltype(concurrent_exec_class(&T::exec)), IOptions>> {};
+
+//! Check if an options class parse in the fields of a struct, cf. cxxsubs::TypedOptions
+template <typename T, typename = void>
+struct is_typed : std::false_type {};
+
+template <typename T>
+struct is_typed<T, std::void_t<typename T::args_type>> : std::true_type {};
+
+//! Check if an options class need the dispatch function
+template <typename T, typename = void>
+struct has_set_dispatch : std::false_type {};
+
+template <typename T>
+struct has_set_dispatch<T, std::void_t<decltype(std::declval<T &>().set_dispatch(std::declval<DispatchFunction>()))>> : std::true_type {};
+
+//! Resource of the options constructed on this thread, null for the default resource
+inline std::pmr::memory_resource *&current_options_resource() {
+  thread_local std::pmr::memory_resource *resource = nullptr;
+  return resource;
+}
+
+//! Resource the options are allocated from when they're constructed
+inline std::pmr::memory_resource *options_resource() {
+  std::pmr::memory_resource *resource = current_options_resource();
+  return resource ? resource : std::pmr::get_default_resource();
+}
+
+//! Allocate the options constructed in its scope from a resource, it must outlive them
+class scoped_options_resource {
+public:
+  explicit scoped_options_resource(std::pmr::memory_resource *resource)
+      : previous(current_options_resource()) {
+    current_options_resource() = resource;
+  }
+  ~scoped_options_resource() {
+    current_options_resource() = this->previous;
+  }
+  scoped_options_resource(const scoped_options_resource &) = delete;
+  scoped_options_resource &operator=(const scoped_options_resource &) = delete;
+
+private:
+  std::pmr::memory_resource *previous;
+};
+
+//! Output of the dispatch running on this thread, null outside of a dispatch
+inline Output *&current_output() {
+  thread_local Output *output = nullptr;
+  return output;
+}
+
+//! Output of the dispatch running on this thread, fallback outside of a dispatch
+inline Output &current_output(Output &fallback) {
+  Output *output = current_output();
+  return output ? *output : fallback;
+}
+
+//! Output flushed to std::cout at each write, used by verbs outside of a dispatch
+inline Output &standard_output() {
+  thread_local Output output;
+  output.setf(std::ios::unitbuf);
+  return output;
+}
+
+//! Set while a command line received by a server is dispatched on this thread
+inline bool &remote_dispatch() {
+  thread_local bool remote = false;
+  return remote;
+}
+
+//! Make verbs dispatched in its scope write in an output, it must outlive them
+class scoped_output {
+public:
+  explicit scoped_output(Output *output)
+      : previous(current_output()) {
+    current_output() = output;
+  }
+  ~scoped_output() {
+    current_output() = this->previous;
+  }
+  scoped_output(const scoped_output &) = delete;
+  scoped_output &operator=(const scoped_output &) = delete;
+
+private:
+  Output *previous;
+};
+
+//! Size of the stack buffer parse results are allocated from during a dispatch
+constexpr std::size_t dispatch_arena_size = 4096;
+
+inline std::string join(const std::string_view *tokens, std::size_t size, std::string_view delimiter) {
+  std::size_t length = size ? (size - 1) * delimiter.size() : 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    length += tokens[i].size();
+  }
+  std::string result;
+  result.reserve(length);
+  for (std::size_t i = 0; i < size; ++i) {
+    if (i) {
+      result.append(delimiter);
+    }
+    result.append(tokens[i]);
+  }
+  return result;
+}
+
 inline std::string join(const std::vector<std::string> &tokens, const std::string &delimiter) {
-  std::stringstream stream;
-  stream << tokens.front();
-  std::for_each(begin(tokens) + 1, end(tokens),
-                [&](const std::string &elem) { stream << delimiter << elem; });
-  return stream.str();
+  std::vector<std::string_view> views(tokens.begin(), tokens.end());
+  return join(views.data(), views.size(), delimiter);
 }
 
 inline std::vector<std::string> split(std::string const &original, char separator) {
@@ -45,12 +636,73 @@ inline std::vector<std::string> split(std::string const &original, char separato
   return results;
 }
 
-inline bool match(std::vector<std::string> verbs, int argc, const char * const *argv) {
+//! Split a command line in words.
+//!
+//! Words are separated by blanks, single or double quotes group words and backslash escape the next character.
+inline std::vector<std::string> split_command_line(std::string_view line) {
+  std::vector<std::string> words;
+  std::string word;
+  bool in_word = false;
+  char quote = '\0';
+  for (std::size_t i = 0; i < line.size(); ++i) {
+    char c = line[i];
+    if (c == '\\' && quote != '\'' && i + 1 < line.size()) {
+      word.push_back(line[++i]);
+      in_word = true;
+    } else if (quote != '\0') {
+      if (c == quote) {
+        quote = '\0';
+      } else {
+        word.push_back(c);
+      }
+    } else if (c == '\'' || c == '"') {
+      quote = c;
+      in_word = true;
+    } else if (c == ' ' || c == '\t' || c == '\r') {
+      if (in_word) {
+        words.push_back(std::move(word));
+        word.clear();
+        in_word = false;
+      }
+    } else {
+      word.push_back(c);
+      in_word = true;
+    }
+  }
+  if (in_word) {
+    words.push_back(std::move(word));
+  }
+  return words;
+}
+
+//! Compare an argv token to a verb word without computing the token length.
+//!
+//! First character is checked before the content, the token must end right after the verb.
+inline bool match_token(std::string_view verb, const char *arg) {
+  if (verb.empty()) {
+    return arg[0] == '\0';
+  }
+  return arg[0] == verb[0] && std::strncmp(arg, verb.data(), verb.size()) == 0 && arg[verb.size()] == '\0';
+}
+
+inline bool match(const std::string_view *verbs, std::size_t depth, int argc, const char * const *argv) {
+  if (std::size_t(argc - 1) < depth) {
+    return false;
+  }
+  for (std::size_t i = 0; i < depth; ++i) {
+    if (!match_token(verbs[i], argv[i + 1])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline bool match(const std::vector<std::string> &verbs, int argc, const char * const *argv) {
   if (std::size_t(argc - 1) < verbs.size()) {
     return false;
   }
   for (std::size_t i = 0; i < verbs.size(); ++i) {
-    if (argv[i + 1] != verbs[i]) {
+    if (!match_token(verbs[i], argv[i + 1])) {
       return false;
     }
   }
@@ -67,63 +719,529 @@ auto for_each(std::tuple<Types...> &t, Function &&f) {
   return for_each_impl(t, std::index_sequence_for<Types...>(), f);
 }
 
+template <typename T, std::size_t... Indices, typename Function>
+auto enumerate_impl(T &&t, std::index_sequence<Indices...>, Function &&f) -> std::array<decltype(f(std::get<0>(t), 0)), sizeof...(Indices)> {
+  return {f(std::get<Indices>(t), Indices)...};
+}
+
+//! Same as for_each but the function also receive the element index, results are returned in an array
+template <typename Tuple, typename Function>
+auto enumerate(Tuple &t, Function &&f) {
+  return enumerate_impl(t, std::make_index_sequence<std::tuple_size<std::remove_const_t<Tuple>>::value>(), f);
+}
+
+//! Entry of the verb table, point to the verb path and description of an options class
+struct VerbEntry {
+  const std::string_view *path = nullptr;
+  std::size_t depth = 0;
+  //! Position of the options class in Verbs template arguments
+  std::size_t index = 0;
+  std::string_view description;
+};
+
+constexpr bool verb_entry_less(const VerbEntry &lhs, const VerbEntry &rhs) {
+  for (std::size_t i = 0; i < lhs.depth && i < rhs.depth; ++i) {
+    if (lhs.path[i] != rhs.path[i]) {
+      return lhs.path[i] < rhs.path[i];
+    }
+  }
+  if (lhs.depth != rhs.depth) {
+    return lhs.depth < rhs.depth;
+  }
+  return lhs.index < rhs.index;
+}
+
+template <typename T, std::size_t Size>
+constexpr void add_verb_entry(std::array<VerbEntry, Size> &entries, std::size_t &count, std::size_t index) {
+  if constexpr (has_static_verb<T>::value) {
+    entries[count++] = VerbEntry{T::verb.path.data(), T::verb.path.size(), index, T::verb.description};
+  }
+}
+
+//! Build at compile time the lexicographically sorted table of the statically declared verbs
+template <typename... Types>
+constexpr auto make_verb_table() {
+  constexpr std::size_t size = (std::size_t(0) + ... + std::size_t(has_static_verb<Types>::value));
+  std::array<VerbEntry, size> entries{};
+  std::size_t count = 0;
+  std::size_t index = 0;
+  (add_verb_entry<Types>(entries, count, index++), ...);
+
+  // insertion sort, std::sort is not constexpr
+  for (std::size_t i = 1; i < size; ++i) {
+    for (std::size_t j = i; j > 0 && verb_entry_less(entries[j], entries[j - 1]); --j) {
+      VerbEntry tmp = entries[j];
+      entries[j] = entries[j - 1];
+      entries[j - 1] = tmp;
+    }
+  }
+  return entries;
+}
+
+template <typename... Types>
+inline constexpr auto verb_table = make_verb_table<Types...>();
+
+//! Walk the verb table with argv, one binary search per argv token.
+//!
+//! \return The deepest verb that is a prefix of argv, the first declared on tie, nullptr if none match
+//!
+template <std::size_t Size>
+const VerbEntry *lookup(const std::array<VerbEntry, Size> &table, int argc, const char * const *argv) {
+  const VerbEntry *best = nullptr;
+  auto first = table.begin();
+  auto last = table.end();
+  for (std::size_t level = 0; first != last; ++level) {
+    // entries that end at this level come first in their range and are complete matches
+    if (first->depth == level) {
+      best = &*first;
+    }
+    for (; first != last && first->depth == level; ++first) {
+    }
+    if (level + 1 >= std::size_t(argc)) {
+      break;
+    }
+    std::string_view token(argv[level + 1]);
+    first = std::lower_bound(first, last, token, [level](const VerbEntry &entry, std::string_view value) {
+      return entry.path[level] < value;
+    });
+    last = std::upper_bound(first, last, token, [level](std::string_view value, const VerbEntry &entry) {
+      return value < entry.path[level];
+    });
+  }
+  return best;
+}
+
+//! Select the single most specific verb matching argv.
+//!
+//! Statically declared verbs are resolved with the verb table, the others with their runtime verbs.
+//!
+//! \return Index of the selected options class, Size if none match
+//!
+template <typename... Types, std::size_t Size>
+std::size_t select(const std::array<VerbEntry, Size> &verbs_table, int argc, const char * const *argv) {
+  constexpr bool is_static[] = {has_static_verb<Types>::value...};
+  std::size_t selected = Size;
+  std::size_t selected_depth = 0;
+  if (const VerbEntry *entry = lookup(verb_table<Types...>, argc, argv)) {
+    selected = entry->index;
+    selected_depth = entry->depth;
+  }
+  for (const VerbEntry &entry : verbs_table) {
+    if (is_static[entry.index] || !match(entry.path, entry.depth, argc, argv)) {
+      continue;
+    }
+    if (selected == Size || entry.depth > selected_depth || (entry.depth == selected_depth && entry.index < selected)) {
+      selected = entry.index;
+      selected_depth = entry.depth;
+    }
+  }
+  return selected;
+}
+
+//! Sort a verb table by path, like the compile time verb table
+template <std::size_t Size>
+std::array<VerbEntry, Size> sort_verb_table(std::array<VerbEntry, Size> table) {
+  std::sort(table.begin(), table.end(), verb_entry_less);
+  return table;
+}
+
+//! Find the verbs starting with the given words in a table sorted by path.
+//!
+//! The last word may be partial (ex: `ship m` give `ship move`), each word cost one binary search.
+//!
+inline std::pair<const VerbEntry *, const VerbEntry *> complete(const VerbEntry *first, const VerbEntry *last, const std::vector<std::string> &words) {
+  for (std::size_t level = 0; level < words.size() && first != last; ++level) {
+    // verbs shorter than the words come first in their range
+    for (; first != last && first->depth == level; ++first) {
+    }
+    std::string_view word = words[level];
+    first = std::lower_bound(first, last, word, [level](const VerbEntry &entry, std::string_view value) {
+      return entry.path[level] < value;
+    });
+    if (level + 1 == words.size()) {
+      last = std::partition_point(first, last, [level, word](const VerbEntry &entry) {
+        return entry.path[level].substr(0, word.size()) == word;
+      });
+    } else {
+      last = std::upper_bound(first, last, word, [level](std::string_view value, const VerbEntry &entry) {
+        return value < entry.path[level];
+      });
+    }
+  }
+  return {first, last};
+}
+
+//! Find the deepest verb formed by the first words, nullptr if none
+inline const VerbEntry *resolve(const VerbEntry *first, const VerbEntry *last, const std::string *words, std::size_t size) {
+  const VerbEntry *best = nullptr;
+  for (; first != last; ++first) {
+    if (first->depth > size || (best && first->depth <= best->depth)) {
+      continue;
+    }
+    std::size_t i = 0;
+    for (; i < first->depth && first->path[i] == words[i]; ++i) {
+    }
+    if (i == first->depth) {
+      best = first;
+    }
+  }
+  return best;
+}
+
+//! Find the option whose value is the last word, after the words of a verb of the given depth.
+//!
+//! The last word is either the value of the option before it or a positional argument.
+//!
+//! \return The option, nullptr if none take this value
+//!
+inline const OptionEntry *value_option(const VerbOptions &options, const std::vector<std::string> &words, std::size_t depth) {
+  auto find = [&options](std::string_view name, bool is_long) -> const OptionEntry * {
+    for (const OptionEntry &option : options.options) {
+      if ((is_long ? option.long_name : option.short_name) == name) {
+        return &option;
+      }
+    }
+    return nullptr;
+  };
+  std::size_t positional = 0;
+  for (std::size_t i = depth; i + 1 < words.size(); ++i) {
+    std::string_view word = words[i];
+    if (word.size() < 2 || word[0] != '-') {
+      ++positional;
+      continue;
+    }
+    // values attached to the option (ex: `--name=value`, `-nvalue`) are not followed by a word
+    bool is_long = word[1] == '-';
+    if ((is_long && word.find('=') != std::string_view::npos) || (!is_long && word.size() > 2)) {
+      continue;
+    }
+    const OptionEntry *option = find(word.substr(is_long ? 2 : 1), is_long);
+    if (option && !option->is_boolean) {
+      if (i + 2 == words.size()) {
+        return option;
+      }
+      ++i;
+    }
+  }
+  if (positional >= options.positional_options.size()) {
+    if (!options.positional_rest) {
+      return nullptr;
+    }
+    positional = options.positional_options.size() - 1;
+  }
+  const std::string &name = options.positional_options[positional];
+  const OptionEntry *option = find(name, true);
+  return option ? option : find(name, false);
+}
+
+//! Cache file of the values completed by a callback for an option of a verb.
+//!
+//! Files are in `${XDG_CACHE_HOME:-${HOME}/.cache}/cxxsubs/values/<program>/`, next to the
+//! candidates cache of the cached bash script.
+//!
+//! \return Path of the file, empty when the program or the cache directory are unknown
+//!
+inline std::filesystem::path values_cache_file(std::string_view program, const VerbEntry &entry, const OptionEntry &option) {
+  std::filesystem::path directory;
+  const char *cache = std::getenv("XDG_CACHE_HOME");
+  const char *home = std::getenv("HOME");
+  if (cache && *cache) {
+    directory = cache;
+  } else if (home && *home) {
+    directory = std::filesystem::path(home) / ".cache";
+  }
+  std::filesystem::path name = std::filesystem::path(program).filename();
+  if (directory.empty() || name.empty()) {
+    return {};
+  }
+  return directory / "cxxsubs" / "values" / name / (join(entry.path, entry.depth, "_") + "." + (option.long_name.empty() ? option.short_name : option.long_name));
+}
+
+//! Print the candidates for the last word in output, one per line.
+//!
+//! They are the next words of the verbs starting with the words, values of the option being
+//! completed or, when the last word start with '-', the options of the verb formed by the previous
+//! words. Values are cached for the program name (ex: argv[0]).
+//!
+inline void print_candidates(std::ostream &output, const VerbEntry *first, const VerbEntry *last, const std::vector<std::string> &words, const OptionsFunction &options_of,
+                             std::string_view program) {
+  const std::string &word = words.back();
+  const VerbEntry *entry = resolve(first, last, words.data(), words.size() - 1);
+  if (entry && word.substr(0, 1) != "-") {
+    // only the callback of the option being completed is called
+    const OptionEntry *option = value_option(options_of(entry->index), words, entry->depth);
+    if (option && option->values) {
+      for (const std::string &value : option->values->values(word, values_cache_file(program, *entry, *option))) {
+        output << value << "\n";
+      }
+    }
+  }
+  if (word.substr(0, 1) == "-") {
+    if (entry) {
+      for (const OptionEntry &option : options_of(entry->index).options) {
+        if (!option.long_name.empty() && ("--" + option.long_name).compare(0, word.size(), word) == 0) {
+          output << "--" << option.long_name << "\n";
+        }
+        if (!option.short_name.empty() && ("-" + option.short_name).compare(0, word.size(), word) == 0) {
+          output << "-" << option.short_name << "\n";
+        }
+      }
+    }
+  } else {
+    std::size_t level = words.size() - 1;
+    std::tie(first, last) = complete(first, last, words);
+    // verbs are sorted so the same word is only repeated in a row
+    for (const VerbEntry *entry = first; entry != last; ++entry) {
+      if (entry->depth > level && (entry == first || (entry - 1)->depth <= level || (entry - 1)->path[level] != entry->path[level])) {
+        output << entry->path[level] << "\n";
+      }
+    }
+  }
+}
+
+//! Get the command line being completed when run by bash `complete -C`.
+//!
+//! Bash call the command with its name, the word to complete and the previous word as arguments
+//! and the command line up to the cursor in COMP_LINE and COMP_POINT.
+//!
+inline bool completion_request(int argc, std::string_view &line) {
+  const char *comp_line = std::getenv("COMP_LINE");
+  const char *comp_point = std::getenv("COMP_POINT");
+  if (argc != 4 || !comp_line || !comp_point) {
+    return false;
+  }
+  line = comp_line;
+  line = line.substr(0, std::min<std::size_t>(std::strtoul(comp_point, nullptr, 10), line.size()));
+  return true;
+}
+
+//! Columns of the terminal on a file descriptor, 0 when it's not a terminal or unknown (-1)
+//!
+//! Define CXXSUBS_HELP_WIDTH to render the help at a fixed width.
+inline std::size_t terminal_width(int fd) {
+#if defined(CXXSUBS_HELP_WIDTH)
+  return CXXSUBS_HELP_WIDTH;
+#elif !defined(_WIN32)
+  winsize size{};
+  if (fd >= 0 && ::ioctl(fd, TIOCGWINSZ, &size) == 0) {
+    return size.ws_col;
+  }
+#endif
+  return 0;
+}
+
+//! Write a pre-rendered text at once
+inline void write_text(std::ostream &output, std::string_view text) {
+  output.write(text.data(), std::streamsize(text.size()));
+}
+
+//! Render the list of available verbs with their description
+inline std::string render_available(const VerbEntry *verbs_table, std::size_t size) {
+  std::string result = "Available command: \n";
+  for (std::size_t k = 0; k < size; ++k) {
+    const VerbEntry &entry = verbs_table[k];
+    std::size_t width = 0;
+    result += "    - ";
+    for (std::size_t i = 0; i < entry.depth; ++i) {
+      if (i) {
+        result += ' ';
+      }
+      result += entry.path[i];
+      width += (i ? 1 : 0) + entry.path[i].size();
+    }
+    result.append(width < 20 ? 20 - width : 0, ' ');
+    result += entry.description;
+    result += '\n';
+  }
+  return result;
+}
+
 } // namespace utils
 
 namespace functors {
 
+//! Construct up front the options that don't declare their verb statically
+struct construct_options {
+  template <typename T>
+  bool operator()(std::optional<T> &t) {
+    if constexpr (!utils::has_static_verb<T>::value) {
+      t.emplace();
+    }
+    return t.has_value();
+  }
+};
+
+//! Construct all options
+struct construct_all_options {
+  template <typename T>
+  bool operator()(std::optional<T> &t) {
+    t.emplace();
+    return true;
+  }
+};
+
+struct set_completions {
+  set_completions(const utils::VerbEntry *verbs_table, std::size_t size, OptionsFunction options_of, std::string_view program)
+      : verbs_table(verbs_table), size(size), options_of(options_of), program(program) {
+  }
+  const utils::VerbEntry *verbs_table;
+  std::size_t size;
+  OptionsFunction options_of;
+  //! Name the program is run with, argv[0]
+  std::string_view program;
+
+  template <typename T>
+  bool operator()(T &t) {
+    return false;
+  }
+};
+
+//! Hand the dispatch function to built-in commands that run other command lines
+struct set_dispatch {
+  set_dispatch(DispatchFunction dispatch)
+      : dispatch(dispatch) {
+  }
+  DispatchFunction dispatch;
+
+  template <typename T>
+  bool operator()(T &t) {
+    if constexpr (utils::has_set_dispatch<T>::value) {
+      t.set_dispatch(this->dispatch);
+      return true;
+    }
+    return false;
+  }
+};
+
 struct execute_options {
-  execute_options(const int argc, const char * const *argv)
-      : argc(argc), argv(argv) {
+  execute_options(const int argc, const char * const *argv, std::size_t selected, bool *running, set_completions inject, set_dispatch inject_dispatch,
+                  std::pmr::memory_resource *options_arena, std::pmr::memory_resource *dispatch_arena)
+      : argc(argc), argv(argv), selected(selected), running(running), inject(inject), inject_dispatch(inject_dispatch),
+        options_arena(options_arena), dispatch_arena(dispatch_arena) {
+  }
+  int argc;
+  const char * const*argv;
+  //! Index of the only options to parse and execute
+  std::size_t selected;
+  //! Options currently executing, a nested dispatch selecting them use a temporary instance
+  bool *running;
+  set_completions inject;
+  set_dispatch inject_dispatch;
+  //! Lazy options live as long as the dispatcher, parse results and temporary options as long as the dispatch
+  std::pmr::memory_resource *options_arena;
+  std::pmr::memory_resource *dispatch_arena;
+
+  //! Mark an options as idle and drop its parse result when its execution end
+  template <typename T>
+  struct release {
+    T &t;
+    bool &running;
+    ~release() {
+      t.parse_result.reset();
+      running = false;
+    }
+  };
+
+  template <typename T>
+  std::tuple<bool, int> operator()(std::optional<T> &t, std::size_t index) {
+    if (index != this->selected) {
+      return {false, EXIT_SUCCESS};
+    }
+    if (this->running[index]) {
+      utils::scoped_options_resource scope(this->dispatch_arena);
+      T parser;
+      return (*this)(parser);
+    }
+    // Lazy options are only constructed the first time their verb is selected
+    if (!t) {
+      utils::scoped_options_resource scope(this->options_arena);
+      t.emplace();
+    }
+    this->running[index] = true;
+    release<T> guard{*t, this->running[index]};
+    return (*this)(*t);
   }
-  int argc;
-  const char * const*argv;
 
   template <typename T>
-  std::tuple<bool, int> operator()(T &&t) {
+  std::tuple<bool, int> operator()(T &t) {
     if (t.match(this->argc, this->argv)) {
+      // inject all verb list in Completion Command and dispatch function in built-in commands
+      this->inject(t);
+      this->inject_dispatch(t);
+
       // Parse argument if return is not a success early return
-      int retParse = t.parse(this->argc, this->argv);
+      int retParse = t.parse(this->argc, this->argv, this->dispatch_arena);
       if (retParse != EXIT_SUCCESS) {
         return {true, retParse};
       }
       // Execute command
-      int retExec = t.exec();
+      int retExec = t.execute();
       return {true, retExec};
     }
     return {false, EXIT_SUCCESS};
   }
 };
 
-struct get_verbs_options {
-  template <typename T>
-  std::string operator()(T &&t) {
-    return t.get_verbs();
+//! Parse and execute with a per dispatch Context, the options is not modified
+struct execute_concurrent {
+  execute_concurrent(const int argc, const char * const *argv, std::size_t selected)
+      : argc(argc), argv(argv), selected(selected) {
   }
-};
+  int argc;
+  const char * const*argv;
+  std::size_t selected;
 
-struct get_description_options {
   template <typename T>
-  std::string operator()(T &&t) {
-    return t.get_desc();
+  std::tuple<bool, int> operator()(const std::optional<T> &t, std::size_t index) {
+    if (index != this->selected) {
+      return {false, EXIT_SUCCESS};
+    }
+    return {true, t->run(this->argc, this->argv)};
   }
 };
 
-struct set_completions {
-  set_completions(std::vector<std::string> verbs_list)
-      : verbs_list(verbs_list) {
+//! Get the options of the verb at index, it's constructed if needed
+struct get_verb_options {
+  get_verb_options(std::size_t index, std::pmr::memory_resource *options_arena)
+      : index(index), options_arena(options_arena) {
   }
-  std::vector<std::string> verbs_list;
+  std::size_t index;
+  std::pmr::memory_resource *options_arena;
+  VerbOptions result;
 
   template <typename T>
-  bool operator()(T &&t) {
-    return false;
+  bool operator()(std::optional<T> &t, std::size_t index) {
+    if (index != this->index) {
+      return false;
+    }
+    if (!t) {
+      utils::scoped_options_resource scope(this->options_arena);
+      t.emplace();
+    }
+    this->result = t->verb_options();
+    return true;
+  }
+};
+
+//! Get verb path and description, static verbs are read from their declaration
+struct get_verb_entry {
+  template <typename T>
+  utils::VerbEntry operator()(const std::optional<T> &t, std::size_t index) {
+    if constexpr (utils::has_static_verb<T>::value) {
+      return {T::verb.path.data(), T::verb.path.size(), index, T::verb.description};
+    } else {
+      return {t->verbs_path, t->verbs_depth, index, t->description};
+    }
   }
 };
 
 } // namespace functors
 
 template <typename FirstOptionsTypes, typename... OptionsTypes>
-int Verbs(int argc, const char * const *argv); // Early declaration
+class Dispatcher; // Early declaration
+
+template <typename FirstOptionsTypes, typename... OptionsTypes>
+class ConcurrentDispatcher; // Early declaration
 
 //! Interface for Options Parser.
 //!
@@ -131,69 +1249,238 @@ int Verbs(int argc, const char * const *argv); // Early declaration
 class IOptions {
 public:
   IOptions(std::vector<std::string> verbs, std::string description = "")
-      : verbs(verbs), description(description) {
+      : runtime_verbs(std::move(verbs)), runtime_description(std::move(description)),
+        runtime_path(runtime_verbs.begin(), runtime_verbs.end()),
+        verbs_path(runtime_path.data()), verbs_depth(runtime_path.size()), description(runtime_description) {
+  }
+  //! Verb path and description point to the static declaration, nothing is copied
+  template <std::size_t Depth>
+  IOptions(const Verb<Depth> &verb)
+      : verbs_path(verb.path.data()), verbs_depth(Depth), description(verb.description) {
   }
+  //! Verb path may point to the instance storage
+  IOptions(const IOptions &) = delete;
+  IOptions &operator=(const IOptions &) = delete;
   ~IOptions() {
   }
 
   //! Function called for parameters validation
-  [[nodiscard]] virtual int validate() = 0;
+  //!
+  //! Default implementation forward to the Context version.
+  [[nodiscard]] virtual int validate() {
+    return this->validate(Context{*this->parse_result, this->out()});
+  }
 
   //! Function that contain execution
-  [[nodiscard]] virtual int exec() = 0;
+  //!
+  //! Default implementation forward to the Context version.
+  [[nodiscard]] virtual int exec() {
+    return this->exec(Context{*this->parse_result, this->out()});
+  }
+
+  //! Function called for parameters validation with the parse result of the current dispatch
+  //!
+  //! Options implementing the Context versions can be used by cxxsubs::ConcurrentDispatcher.
+  [[nodiscard]] virtual int validate(const Context &) const {
+    return EXIT_SUCCESS;
+  }
+
+  //! Function that contain execution with the parse result of the current dispatch
+  [[nodiscard]] virtual int exec(const Context &context) const {
+    context.output << "Error: " << this->get_verbs() << " does not implement exec\n";
+    return EXIT_FAILURE;
+  }
 
 private:
   template <typename FirstOptionsTypes, typename... OptionsTypes>
-  friend int Verbs(int argc, const char * const *argv);
+  friend class Dispatcher;
+  template <typename FirstOptionsTypes, typename... OptionsTypes>
+  friend class ConcurrentDispatcher;
 
   //! Functor use to process all options, there need access to private member
   friend class functors::execute_options;
-  friend class functors::get_verbs_options;
-  friend class functors::get_description_options;
+  friend class functors::execute_concurrent;
+  friend class functors::get_verb_entry;
+  friend class functors::get_verb_options;
 
   bool match(int argc, const char * const *argv) {
-    return utils::match(this->verbs, argc, argv);
+    return utils::match(this->verbs_path, this->verbs_depth, argc, argv);
   }
 
-  virtual int parse(int argc, const char * const *argv) {
+  //! The parse result is allocated from resource, it's dropped before the end of the dispatch
+  virtual int parse(int argc, const char * const *argv, std::pmr::memory_resource *resource) {
     if (this->match(argc, argv)) {
-      int tmp_argc = argc - verbs.size();
-      const char * const *tmp_argv = argv + verbs.size();
+      int tmp_argc = argc - verbs_depth;
+      const char * const *tmp_argv = argv + verbs_depth;
+      this->reset_args();
       this->parse_result =
-          std::make_unique<cxxopts::ParseResult>(this->options.parse(tmp_argc, tmp_argv));
+          std::make_unique<cxxopts::ParseResult>(this->options.parse(tmp_argc, tmp_argv, resource));
       return this->validate();
     }
     return EXIT_SUCCESS;
   }
 
-  std::vector<std::string> verbs;
-  std::string description;
+  //! Called before each parse, options parsing in their own storage reset it
+  virtual void reset_args() {
+  }
+
+  //! Call exec through IOptions, the options class may only declare the Context version
+  int execute() {
+    return this->exec();
+  }
+
+  //! Parse in a local result and run validate and exec with it, the instance is not modified
+  int run(int argc, const char * const *argv) const {
+    std::array<std::byte, utils::dispatch_arena_size> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    cxxopts::ParseResult result = this->options.parse(argc - int(verbs_depth), argv + verbs_depth, &arena);
+    Context context{result, this->out()};
+    int ret = this->validate(context);
+    if (ret != EXIT_SUCCESS) {
+      return ret;
+    }
+    return this->exec(context);
+  }
+
+  //! Options of all groups in declaration order and positional hints
+  VerbOptions verb_options() const {
+    VerbOptions result{{}, {}, {}, false};
+    std::map<std::string, bool> containers;
+    for (const auto &group : this->options.groups()) {
+      for (const auto &option : this->options.group_help(group).options) {
+        auto values = this->completers.find(option.l.empty() ? option.s : option.l);
+        if (values == this->completers.end()) {
+          values = this->completers.find(option.s);
+        }
+        result.options.push_back({option.s, option.l, option.desc, option.arg_help, option.is_boolean, option.is_container,
+                                  values == this->completers.end() ? nullptr : values->second});
+        containers[option.l] = option.is_container;
+      }
+    }
+    // positional_help is used when it give one hint per positional argument
+    const std::vector<std::string> &positional = this->options.positional_options();
+    result.positional_options = positional;
+    std::vector<std::string> hints = utils::split_command_line(this->options.positional_help_text());
+    for (std::size_t i = 0; i < positional.size(); ++i) {
+      result.positional.push_back(hints.size() == positional.size() ? hints[i] : "<" + positional[i] + ">");
+    }
+    result.positional_rest = !positional.empty() && containers[positional.back()];
+    return result;
+  }
+
+  //! Values completion callbacks by option name
+  std::map<std::string, std::shared_ptr<ValuesCompleter>> completers;
+
+  //! Help rendered for each terminal width, 0 for the width of the options
+  mutable std::mutex help_mutex;
+  mutable std::map<std::size_t, std::string> help_cache;
+
+  //! Storage used only when verbs are given at runtime
+  std::vector<std::string> runtime_verbs;
+  std::string runtime_description;
+  std::vector<std::string_view> runtime_path;
+
+  const std::string_view *verbs_path;
+  std::size_t verbs_depth;
+  std::string_view description;
 
 protected:
+  //! Complete the values of an option, or of the positional argument it's filled by, with a callback
+  //!
+  //! \param option  Long or short name of the option
+  //! \param function  Callback giving all the possible values, they're filtered by the completion
+  //! \param ttl  Time the values are kept before the callback is called again
+  //! \param budget  Time after which the completion give up waiting for the callback
+  //!
+  void complete_values(const std::string &option, ValuesFunction function, std::chrono::milliseconds ttl = std::chrono::seconds(30),
+                       std::chrono::milliseconds budget = std::chrono::milliseconds(200)) {
+    this->completers[option] = std::make_shared<ValuesCompleter>(std::move(function), ttl, budget);
+  }
+
+  //! Print the help of this verb.
+  //!
+  //! It's rendered the first time for the width of the terminal the output is written to, or of
+  //! the options when it's not a terminal (ex: a string or the socket of a server client), and
+  //! written at once.
+  void print_help() const {
+    std::size_t width = utils::terminal_width(this->out().descriptor());
+    std::unique_lock<std::mutex> lock(this->help_mutex);
+    auto found = this->help_cache.find(width);
+    if (found == this->help_cache.end()) {
+      found = this->help_cache.emplace(width, (width ? this->options.help({""}, width) : this->options.help({""})) + "\n").first;
+    }
+    // rendered help are never removed
+    lock.unlock();
+    utils::write_text(this->out(), found->second);
+  }
+
+  //! Output of the current dispatch, std::cout outside of a dispatch (ex: print_help called by main)
+  Output &out() const {
+    return utils::current_output(utils::standard_output());
+  }
+
   //! Get the verb of this option
-  std::string get_verbs() {
-    return utils::join(this->verbs, " ");
+  std::string get_verbs() const {
+    return utils::join(this->verbs_path, this->verbs_depth, " ");
   }
 
   //! Get the description of this option
-  std::string get_desc() {
-    return this->description;
+  std::string get_desc() const {
+    return std::string(this->description);
   }
 
-  cxxopts::Options options = cxxopts::Options(this->get_verbs(), this->description);
+  cxxopts::Options options = cxxopts::Options(this->get_verbs(), this->get_desc(), utils::options_resource());
   std::unique_ptr<cxxopts::ParseResult> parse_result;
 };
 
+//! Options parsed straight in the fields of a struct.
+//!
+//! Each option is bound to a field with `this->field(&Args::member)` when it's declared, the parser
+//! write its value in `this->args` so validate and exec read it without lookup, RTTI or hashing.
+//! `args` is reset to `Args{}` before each parse: default member initializers are the values of the
+//! absent options, a std::optional field tell if its option is given. The fields are shared by all
+//! dispatches, these options can't be used by cxxsubs::ConcurrentDispatcher.
+//!
+//! \tparam Args  Struct with one field per option
+//!
+template <typename Args>
+class TypedOptions : public IOptions {
+public:
+  using args_type = Args;
+  using IOptions::IOptions;
+
+protected:
+  //! Value of an option stored in a field of args
+  template <typename T>
+  std::shared_ptr<cxxopts::Value> field(T Args::*member) {
+    return cxxopts::value<T>(this->args.*member);
+  }
+
+  Args args;
+
+private:
+  void reset_args() override {
+    this->args = Args{};
+  }
+};
+
 class CompletionCommand : public cxxsubs::IOptions {
 public:
+  static constexpr Verb<1> verb = {{"completion"}, "Completion Command for bash, zsh and fish"};
+
   CompletionCommand()
-      : cxxsubs::IOptions({"completion"}, "Completion Command for bash") {
+      : cxxsubs::IOptions(verb) {
 
     // clang-format off
     this->options.add_options()
       ("verbs", "verbs list for each command", cxxopts::value<std::vector<std::string>>())
       ("show", "show completion code to add in bashrc", cxxopts::value<bool>())
       ("exec_name", "the executable name to add in completion script", cxxopts::value<std::string>())
+      ("static", "with show, bake verbs and options in the bash script so completion never run the executable", cxxopts::value<bool>())
+      ("shell", "with show, shell of the completion script: bash, zsh or fish", cxxopts::value<std::string>()->default_value("bash"))
+      ("direct", "with show, bash run the executable to complete without script function (complete -C)", cxxopts::value<bool>())
+      ("cache", "with show, the bash script read candidates from a cache file written by the executable when it change", cxxopts::value<bool>())
+      ("write_cache", "write the candidates cache file read by the cached bash script", cxxopts::value<std::string>())
       ("help", "Print help");
 
     // clang-format on
@@ -202,115 +1489,756 @@ public:
 
   int validate() {
     if (this->parse_result->count("help")) {
-      std::cout << this->options.help({""}) << std::endl;
+      this->print_help();
       return EXIT_FAILURE;
     }
 
     if (this->parse_result->count("show") ^ this->parse_result->count("exec_name")) {
-      std::cout << "Error: parsing options: 'show' and 'exec_name' must be filled" << std::endl;
+      this->out() << "Error: parsing options: 'show' and 'exec_name' must be filled\n";
+      return EXIT_FAILURE;
+    }
+
+    const std::string &shell = (*this->parse_result)["shell"].as<std::string>();
+    if (shell != "bash" && shell != "zsh" && shell != "fish") {
+      this->out() << "Error: parsing options: unknown shell '" << shell << "'\n";
       return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
   }
 
   int exec() {
-    if (this->parse_result->count("show")) {
+    const std::string &shell = (*this->parse_result)["shell"].as<std::string>();
+    if (this->parse_result->count("show") && shell == "zsh") {
+      this->show_zsh((*this->parse_result)["exec_name"].as<std::string>());
+    } else if (this->parse_result->count("show") && shell == "fish") {
+      this->show_fish((*this->parse_result)["exec_name"].as<std::string>());
+    } else if (this->parse_result->count("show") && this->parse_result->count("direct")) {
+      // bash run the executable itself, cf. cxxsubs::Verbs
       std::string my_name = (*this->parse_result)["exec_name"].as<std::string>();
-      std::cout << "_" + my_name + "_completions() {\n"
-                                   "  local cur_word args type_list\n"
-                                   "  cur_word=\"${COMP_WORDS[COMP_CWORD]}\"\n"
-                                   "  args=(\"${COMP_WORDS[@]}\")\n\n"
-                                   "  type_list=$(" +
-                       my_name + " completion ${args[@]:1})\n"
-                                 "  COMPREPLY=( $(compgen -W \"${type_list}\" -- ${cur_word}) )\n\n"
-                                 "  # if no match was found, fall back to filename completion\n"
-                                 "  if [ ${#COMPREPLY[@]} -eq 0 ]; then\n"
-                                 "    COMPREPLY=( $(compgen -f -- \"${cur_word}\" ) )\n"
+      this->out() << "complete -o default -C " << my_name << " " << my_name << "\n";
+    } else if (this->parse_result->count("show") && this->parse_result->count("cache")) {
+      this->show_cached_bash((*this->parse_result)["exec_name"].as<std::string>());
+    } else if (this->parse_result->count("write_cache")) {
+      return this->write_cache((*this->parse_result)["write_cache"].as<std::string>());
+    } else if (this->parse_result->count("show") && this->parse_result->count("static")) {
+      this->show_static_bash((*this->parse_result)["exec_name"].as<std::string>());
+    } else if (this->parse_result->count("show")) {
+      std::string my_name = (*this->parse_result)["exec_name"].as<std::string>();
+      this->out() << "_" + my_name + "_completions() {\n"
+                                     "  local cur_word args type_list\n"
+                                     "  cur_word=\"${COMP_WORDS[COMP_CWORD]}\"\n"
+                                     "  args=(\"${COMP_WORDS[@]}\")\n\n"
+                                     "  type_list=$(" +
+                         my_name + " completion -- \"${args[@]:1}\")\n"
+                                   "  COMPREPLY=( $(compgen -W \"${type_list}\" -- ${cur_word}) )\n\n"
+                                   "  # if no match was found, fall back to filename completion\n"
+                                   "  if [ ${#COMPREPLY[@]} -eq 0 ]; then\n"
+                                   "    COMPREPLY=( $(compgen -f -- \"${cur_word}\" ) )\n"
+                                   "  fi\n"
+                                   "  return 0\n"
+                                   "}\n"
+                                   "complete -F _" +
+                         my_name + "_completions " + my_name
+                  << "\n";
+    } else {
+      std::vector<std::string> words = {""};
+      if ((*this->parse_result).count("verbs")) {
+        words = (*this->parse_result)["verbs"].as<std::vector<std::string>>();
+      }
+      utils::print_candidates(this->out(), this->verbs_table, this->verbs_table + this->verbs_table_size, words, this->options_of, this->program);
+    }
+    return EXIT_SUCCESS;
+  };
+
+  void set_verbs_table(const utils::VerbEntry *verbs_table, std::size_t size, OptionsFunction options_of, std::string_view program) {
+    this->verbs_table = verbs_table;
+    this->verbs_table_size = size;
+    this->options_of = options_of;
+    this->program = program;
+  }
+
+private:
+  //! Node of the verb tree, keyed by the words leading to it
+  struct CompletionNode {
+    //! Next verb words with the description of the verb they complete, if any
+    std::vector<std::pair<std::string_view, std::string_view>> children;
+    //! Set when the words form a verb
+    const utils::VerbEntry *verb = nullptr;
+  };
+
+  //! Build the verb tree and get the options of each verb, longest verbs first
+  void completion_tree(std::map<std::string, CompletionNode> &tree, std::vector<std::pair<std::string, VerbOptions>> &verbs) {
+    for (std::size_t k = 0; k < this->verbs_table_size; ++k) {
+      const utils::VerbEntry &entry = this->verbs_table[k];
+      std::string prefix;
+      for (std::size_t i = 0; i < entry.depth; ++i) {
+        auto &children = tree[prefix].children;
+        std::string_view description = i + 1 == entry.depth ? entry.description : std::string_view();
+        if (children.empty() || children.back().first != entry.path[i]) {
+          children.emplace_back(entry.path[i], description);
+        } else if (!description.empty()) {
+          children.back().second = description;
+        }
+        prefix += (i ? " " : "") + std::string(entry.path[i]);
+      }
+      tree[prefix].verb = &entry;
+      verbs.emplace_back(prefix, this->options_of(entry.index));
+    }
+    std::stable_sort(verbs.begin(), verbs.end(), [](const auto &lhs, const auto &rhs) { return lhs.first.size() > rhs.first.size(); });
+  }
+
+  //! Option names separated by space
+  static std::string flags(const VerbOptions &options) {
+    std::string result;
+    for (const OptionEntry &option : options.options) {
+      if (!option.long_name.empty()) {
+        result += (result.empty() ? "--" : " --") + option.long_name;
+      }
+      if (!option.short_name.empty()) {
+        result += (result.empty() ? "-" : " -") + option.short_name;
+      }
+    }
+    return result;
+  }
+
+  //! Escape text for a bash or zsh single quoted string, special characters are escaped for zsh specs
+  static std::string quote(std::string_view text, std::string_view special = "", char escape = '\\') {
+    std::string result;
+    for (char c : text) {
+      if (c == '\'') {
+        result += "'\\''";
+        continue;
+      }
+      if (special.find(c) != std::string_view::npos) {
+        result += escape;
+      }
+      result += c;
+    }
+    return result;
+  }
+
+  //! Escape text for a fish single quoted string
+  static std::string fish_quote(std::string_view text) {
+    std::string result;
+    for (char c : text) {
+      if (c == '\'' || c == '\\') {
+        result += '\\';
+      }
+      result += c;
+    }
+    return result;
+  }
+
+  //! Bash candidates for each exact words prefix and for the words following each verb
+  void bash_candidates(std::vector<std::pair<std::string, std::string>> &exact, std::vector<std::pair<std::string, std::string>> &verbs) {
+    std::map<std::string, CompletionNode> tree;
+    std::vector<std::pair<std::string, VerbOptions>> verb_options;
+    this->completion_tree(tree, verb_options);
+    for (const auto &[prefix, options] : verb_options) {
+      verbs.emplace_back(prefix, flags(options));
+    }
+    for (const auto &[prefix, node] : tree) {
+      std::string candidates;
+      for (const auto &child : node.children) {
+        candidates += (candidates.empty() ? "" : " ") + std::string(child.first);
+      }
+      if (node.verb) {
+        auto verb = std::find_if(verbs.begin(), verbs.end(), [&](const auto &v) { return v.first == prefix; });
+        candidates += (candidates.empty() ? "" : " ") + verb->second;
+      }
+      exact.emplace_back(prefix, candidates);
+    }
+  }
+
+  //! Write the bash candidates in a cache file read by the cached completion function.
+  //!
+  //! Each line is a key and its candidates separated by a tab, keys are `=` followed by exact
+  //! words then `*` followed by verbs, longest first. Other cache files of the executable are
+  //! removed as they belong to previous builds.
+  int write_cache(const std::string &path) {
+    std::vector<std::pair<std::string, std::string>> exact;
+    std::vector<std::pair<std::string, std::string>> verbs;
+    this->bash_candidates(exact, verbs);
+
+    std::filesystem::path cache(path);
+    std::error_code error = utils::write_file(cache, [&exact, &verbs](std::ostream &output) {
+      for (const auto &[prefix, candidates] : exact) {
+        output << "=" << prefix << "\t" << candidates << "\n";
+      }
+      for (const auto &[prefix, candidates] : verbs) {
+        output << "*" << prefix << "\t" << candidates << "\n";
+      }
+    });
+    if (error) {
+      this->out() << "Error: can't write completion cache " << path << ": " << error.message() << "\n";
+      return EXIT_FAILURE;
+    }
+
+    // cache files are named <executable>.<inode>.<mtime>.<size>
+    std::string stem = cache.filename().string();
+    for (int i = 0; i < 3 && stem.rfind('.') != std::string::npos; ++i) {
+      stem.resize(stem.rfind('.'));
+    }
+    for (const auto &file : std::filesystem::directory_iterator(cache.parent_path(), error)) {
+      if (file.path() != cache && is_cache_name(file.path().filename().string(), stem)) {
+        std::filesystem::remove(file.path(), error);
+      }
+    }
+    return EXIT_SUCCESS;
+  }
+
+  //! Check if a file name is `<stem>.<inode>.<mtime>.<size>` with numeric fields
+  static bool is_cache_name(std::string_view name, std::string_view stem) {
+    if (name.size() <= stem.size() || name.substr(0, stem.size()) != stem) {
+      return false;
+    }
+    name.remove_prefix(stem.size());
+    for (int i = 0; i < 3; ++i) {
+      if (name.size() < 2 || name[0] != '.') {
+        return false;
+      }
+      std::size_t digits = name.find_first_not_of("0123456789", 1);
+      if (digits == 1) {
+        return false;
+      }
+      name.remove_prefix(digits == std::string_view::npos ? name.size() : digits);
+    }
+    return name.empty();
+  }
+
+  //! Print a bash completion function reading its candidates from a cache file.
+  //!
+  //! The cache is keyed by the inode, modification time and size of the executable, it's written
+  //! by the executable only when missing, so once warm pressing TAB never run it.
+  void show_cached_bash(const std::string &my_name) {
+    this->out() << "_" + my_name + "_completions() {\n"
+                                   "  local IFS=$' \\t\\n'\n"
+                                   "  local cur_word=\"${COMP_WORDS[COMP_CWORD]}\"\n"
+                                   "  local words=\"${COMP_WORDS[*]:1:COMP_CWORD-1}\"\n"
+                                   "  local executable key cache candidates candidate\n"
+                                   "  executable=$(type -P " +
+                       my_name + ") || return 0\n"
+                                 "  key=$(stat -L -c '%i.%Y.%s' \"${executable}\" 2>/dev/null || stat -L -f '%i.%m.%z' \"${executable}\") || return 0\n"
+                                 "  cache=\"${XDG_CACHE_HOME:-${HOME}/.cache}/cxxsubs/" +
+                       my_name + ".${key}\"\n"
+                                 "  if [[ ! -f \"${cache}\" ]]; then\n"
+                                 "    \"${executable}\" completion --write_cache \"${cache}\" > /dev/null || return 0\n"
                                  "  fi\n"
+                                 "  while IFS=$'\\t' read -r key candidates; do\n"
+                                 "    [[ \"${key}\" == \"=${words}\" || ( \"${key}\" == \"*\"* && \"${words} \" == \"${key:1} \"?* ) ]] && break\n"
+                                 "    candidates=\"\"\n"
+                                 "  done < \"${cache}\"\n"
+                                 "  COMPREPLY=()\n"
+                                 "  for candidate in ${candidates}; do\n"
+                                 "    [[ \"${candidate}\" == \"${cur_word}\"* ]] && COMPREPLY+=(\"${candidate}\")\n"
+                                 "  done\n"
                                  "  return 0\n"
                                  "}\n"
-                                 "complete -F _" +
+                                 "# if no match was found, bash fall back to filename completion\n"
+                                 "complete -o default -F _" +
                        my_name + "_completions " + my_name
-                << std::endl;
-    } else {
+                << "\n";
+  }
 
-      for (auto &&i : this->other_verbs_list) {
-        if ((*this->parse_result).count("verbs")) {
-          std::regex patterns(utils::join((*this->parse_result)["verbs"].as<std::vector<std::string>>(), " ") + ".*");
-          std::smatch pieces_match;
-          if (std::regex_match(i, pieces_match, patterns)) {
-            std::cout << i << std::endl;
-          }
-        } else {
-          // this part is never used in real case autocompetion pass empty string so there is a verb
-          std::cout << utils::split(i, ' ')[0] << std::endl;
+  //! Print a bash completion function with the verb tree and options in case patterns.
+  //!
+  //! The words before the cursor select the candidates: sub verbs and options of the verb they
+  //! form, or only the options once a complete verb is followed by other words.
+  void show_static_bash(const std::string &my_name) {
+    std::vector<std::pair<std::string, std::string>> exact;
+    std::vector<std::pair<std::string, std::string>> verbs;
+    this->bash_candidates(exact, verbs);
+
+    this->out() << "_" + my_name + "_completions() {\n"
+                                   "  local IFS=$' \\t\\n'\n"
+                                   "  local cur_word=\"${COMP_WORDS[COMP_CWORD]}\"\n"
+                                   "  local words=\"${COMP_WORDS[*]:1:COMP_CWORD-1}\"\n"
+                                   "  local candidates candidate\n"
+                                   "  case \"${words}\" in\n";
+    for (const auto &[prefix, candidates] : exact) {
+      this->out() << "    \"" << prefix << "\") candidates=\"" << candidates << "\" ;;\n";
+    }
+    for (const auto &[prefix, candidates] : verbs) {
+      this->out() << "    \"" << prefix << " \"*) candidates=\"" << candidates << "\" ;;\n";
+    }
+    this->out() << "    *) candidates=\"\" ;;\n"
+                   "  esac\n"
+                   "  COMPREPLY=()\n"
+                   "  for candidate in ${candidates}; do\n"
+                   "    [[ \"${candidate}\" == \"${cur_word}\"* ]] && COMPREPLY+=(\"${candidate}\")\n"
+                   "  done\n"
+                   "  return 0\n"
+                   "}\n"
+                   "# if no match was found, bash fall back to filename completion\n"
+                   "complete -o default -F _" +
+                       my_name + "_completions " + my_name
+                << "\n";
+  }
+
+  //! Print a zsh completion function, verbs are listed with _describe and options with _arguments.
+  //!
+  //! Once a verb is complete the words are shifted so _arguments see the verb as the command.
+  void show_zsh(const std::string &my_name) {
+    std::map<std::string, CompletionNode> tree;
+    std::vector<std::pair<std::string, VerbOptions>> verbs;
+    this->completion_tree(tree, verbs);
+
+    this->out() << "#compdef " << my_name << "\n"
+                << "_" << my_name << "() {\n"
+                                     "  local words_prefix=\"${(j: :)words[2,CURRENT-1]}\"\n"
+                                     "  local -a candidates\n"
+                                     "  local ret=1\n"
+                                     "  case \"${words_prefix}\" in\n";
+    for (const auto &[prefix, node] : tree) {
+      if (node.children.empty()) {
+        continue;
+      }
+      this->out() << "    '" << quote(prefix) << "')\n"
+                  << "      candidates=(";
+      for (std::size_t i = 0; i < node.children.size(); ++i) {
+        this->out() << (i ? " " : "") << "'" << quote(node.children[i].first, ":");
+        if (!node.children[i].second.empty()) {
+          this->out() << ":" << quote(node.children[i].second);
+        }
+        this->out() << "'";
+      }
+      this->out() << ")\n"
+                  << "      _describe -t verbs 'verb' candidates && ret=0\n";
+      if (node.verb) {
+        auto verb = std::find_if(verbs.begin(), verbs.end(), [&](const auto &v) { return v.first == prefix; });
+        this->out() << "      shift " << node.verb->depth << " words\n"
+                    << "      (( CURRENT -= " << node.verb->depth << " ))\n"
+                    << "      " << zsh_arguments(verb->second) << " && ret=0\n";
+      }
+      this->out() << "      ;;\n";
+    }
+    for (const auto &[prefix, options] : verbs) {
+      std::size_t depth = tree[prefix].verb->depth;
+      this->out() << "    '" << quote(prefix) << "'|'" << quote(prefix) << " '*)\n"
+                  << "      shift " << depth << " words\n"
+                  << "      (( CURRENT -= " << depth << " ))\n"
+                  << "      " << zsh_arguments(options) << " && ret=0\n"
+                  << "      ;;\n";
+    }
+    this->out() << "  esac\n"
+                   "  return ret\n"
+                   "}\n"
+                   "compdef _"
+                << my_name << " " << my_name << "\n";
+  }
+
+  //! _arguments call with one spec per option and the positional hints
+  static std::string zsh_arguments(const VerbOptions &options) {
+    std::string result = "_arguments -s";
+    for (const OptionEntry &option : options.options) {
+      std::string description = "[" + quote(option.description, "[]") + "]";
+      std::string value = option.is_boolean ? "" : ":" + quote(option.arg_help.empty() ? option.long_name : option.arg_help, ":") + ":";
+      std::string repeat = option.is_container ? "'*'" : "";
+      if (!option.short_name.empty() && !option.long_name.empty()) {
+        std::string exclusion = option.is_container ? "" : "'(-" + option.short_name + " --" + option.long_name + ")'";
+        result += " " + exclusion + repeat + "{-" + option.short_name + ",--" + option.long_name + "}'" + description + value + "'";
+      } else {
+        std::string name = option.long_name.empty() ? "-" + option.short_name : "--" + option.long_name;
+        result += " " + repeat + "'" + name + description + value + "'";
+      }
+    }
+    for (std::size_t i = 0; i < options.positional.size(); ++i) {
+      bool rest = options.positional_rest && i + 1 == options.positional.size();
+      result += " '" + (rest ? std::string("*") : std::to_string(i + 1)) + ":" + quote(options.positional[i], ":") + ": '";
+    }
+    return result;
+  }
+
+  //! Print fish completions, a helper function find the most specific verb of the command line
+  void show_fish(const std::string &my_name) {
+    std::map<std::string, CompletionNode> tree;
+    std::vector<std::pair<std::string, VerbOptions>> verbs;
+    this->completion_tree(tree, verbs);
+
+    std::string words_is = "__fish_" + my_name + "_words_is";
+    std::string verb_is = "__fish_" + my_name + "_verb_is";
+    this->out() << "function " << words_is << "\n"
+                << "    set -l words (commandline -opc)\n"
+                   "    set -e words[1]\n"
+                   "    test \"$words\" = \"$argv[1]\"\n"
+                   "end\n"
+                << "function " << verb_is << "\n"
+                << "    set -l words (commandline -opc)\n"
+                   "    set -e words[1]\n"
+                   "    for verb in";
+    for (const auto &[prefix, options] : verbs) {
+      this->out() << " '" << fish_quote(prefix) << "'";
+    }
+    this->out() << "\n"
+                   "        if test \"$words\" = \"$verb\"; or string match -q -- \"$verb *\" \"$words\"\n"
+                   "            test \"$verb\" = \"$argv[1]\"\n"
+                   "            return\n"
+                   "        end\n"
+                   "    end\n"
+                   "    return 1\n"
+                   "end\n";
+    for (const auto &[prefix, node] : tree) {
+      for (const auto &[word, description] : node.children) {
+        std::string child = prefix.empty() ? std::string(word) : prefix + " " + std::string(word);
+        std::string hint;
+        auto verb = std::find_if(verbs.begin(), verbs.end(), [&](const auto &v) { return v.first == child; });
+        if (verb != verbs.end()) {
+          hint = utils::join(verb->second.positional, " ");
+        }
+        std::string text = std::string(description) + (!description.empty() && !hint.empty() ? " " : "") + hint;
+        this->out() << "complete -c " << my_name << " -f -n '" << fish_quote(words_is + " '" + fish_quote(prefix) + "'") << "' -a '" << fish_quote(word) << "'";
+        if (!text.empty()) {
+          this->out() << " -d '" << fish_quote(text) << "'";
+        }
+        this->out() << "\n";
+      }
+    }
+    for (const auto &[prefix, options] : verbs) {
+      for (const OptionEntry &option : options.options) {
+        this->out() << "complete -c " << my_name << " -n '" << fish_quote(verb_is + " '" + fish_quote(prefix) + "'") << "'";
+        if (!option.long_name.empty()) {
+          this->out() << " -l '" << fish_quote(option.long_name) << "'";
+        }
+        if (!option.short_name.empty()) {
+          this->out() << " -s '" << fish_quote(option.short_name) << "'";
+        }
+        if (!option.is_boolean) {
+          this->out() << " -r";
+        }
+        if (!option.description.empty()) {
+          this->out() << " -d '" << fish_quote(option.description) << "'";
         }
+        this->out() << "\n";
       }
     }
+  }
+
+  //! Verb path and description of all options sorted by path, owned by the dispatcher
+  const utils::VerbEntry *verbs_table = nullptr;
+  std::size_t verbs_table_size = 0;
+  OptionsFunction options_of;
+  //! Name the program is run with, values completed by callbacks are cached for it
+  std::string program;
+};
+
+//! Built-in command executing command lines read from a file or stdin.
+//!
+//! Each line is dispatched in the same process and its exit code reported, empty lines and lines
+//! starting with '#' are skipped.
+//!
+class BatchCommand : public cxxsubs::IOptions {
+public:
+  static constexpr Verb<1> verb = {{"batch"}, "Execute command lines from a file or stdin"};
+
+  BatchCommand()
+      : cxxsubs::IOptions(verb) {
+
+    // clang-format off
+    this->options.add_options()
+      ("file", "file with one command line per line, stdin if missing or '-'", cxxopts::value<std::string>())
+      ("fail-fast", "stop at the first command that fail", cxxopts::value<bool>())
+      ("help", "Print help");
+
+    // clang-format on
+    options.parse_positional({"file"});
+  }
+
+  int validate() {
+    if (this->parse_result->count("help")) {
+      this->print_help();
+      return EXIT_FAILURE;
+    }
+    // it would read the input and files of the server
+    if (utils::remote_dispatch()) {
+      this->out() << "Error: batch can't be run by a server client\n";
+      return EXIT_FAILURE;
+    }
     return EXIT_SUCCESS;
+  }
+
+  int exec() {
+    std::ifstream file;
+    std::istream *input = &std::cin;
+    if (this->parse_result->count("file") && (*this->parse_result)["file"].as<std::string>() != "-") {
+      const std::string &filename = (*this->parse_result)["file"].as<std::string>();
+      file.open(filename);
+      if (!file) {
+        this->out() << "Error: can't open file: " << filename << "\n";
+        return EXIT_FAILURE;
+      }
+      input = &file;
+    }
+    bool fail_fast = this->parse_result->count("fail-fast");
+
+    int returnCode = EXIT_SUCCESS;
+    std::string line;
+    std::vector<const char *> argv;
+    for (std::size_t line_number = 1; std::getline(*input, line); ++line_number) {
+      std::vector<std::string> words = utils::split_command_line(line);
+      if (words.empty() || words.front()[0] == '#') {
+        continue;
+      }
+      // dispatch expect the program name first
+      argv.assign(1, "batch");
+      for (auto &word : words) {
+        argv.push_back(word.c_str());
+      }
+      argv.push_back(nullptr);
+
+      int ret = this->dispatch(int(argv.size() - 1), argv.data());
+      this->out() << "line " << line_number << ": exit code " << ret << "\n";
+      if (ret != EXIT_SUCCESS) {
+        returnCode = EXIT_FAILURE;
+        if (fail_fast) {
+          break;
+        }
+      }
+    }
+    return returnCode;
   };
 
-  void set_verbs_list(std::vector<std::string> verbs) {
-    this->other_verbs_list = verbs;
+  void set_dispatch(DispatchFunction dispatch) {
+    this->dispatch = dispatch;
   }
 
 private:
-  std::vector<std::string> other_verbs_list;
+  DispatchFunction dispatch;
 };
 
 namespace functors {
 
 // Specialize set completion for Completion Command class
 template <>
-inline bool set_completions::operator()<CompletionCommand &>(CompletionCommand &t) {
-  t.set_verbs_list(verbs_list);
+inline bool set_completions::operator()<CompletionCommand>(CompletionCommand &t) {
+  t.set_verbs_table(verbs_table, size, options_of, program);
   return true;
 }
 
 } // namespace functors
 
-//! Subcommand Parser.
+//! Subcommand Parser built once and dispatching any number of command lines.
+//!
+//! Only the most specific verb matching the command line is parsed and executed (ex: `ship new`
+//! and not `ship`). Options classes with a static cxxsubs::Verb declaration are constructed the
+//! first time they are selected, the others with the dispatcher. They are then kept, with their
+//! cxxopts::Options, for the next dispatches and their parse result is dropped after each one.
+//! Dispatch is re-entrant: a verb dispatched while it is already executing use a temporary instance.
 //!
 //! \tparam FirstOptionsTypes  Used to force at least one argument in template
 //! \tparam OptionsTypes  Other template arguments
 //!
 template <typename FirstOptionsTypes, typename... OptionsTypes>
-int Verbs(const int argc, const char * const *argv) {
-  try {
-    std::tuple<FirstOptionsTypes, OptionsTypes...> parsers;
-    std::size_t length = sizeof...(OptionsTypes) + 1;
+class Dispatcher {
+  static_assert((utils::has_exec<FirstOptionsTypes>::value || utils::is_concurrent<FirstOptionsTypes>::value) &&
+                    ((utils::has_exec<OptionsTypes>::value || utils::is_concurrent<OptionsTypes>::value) && ...),
+                "Dispatcher options must implement exec() or exec(const cxxsubs::Context &) const");
+
+public:
+  Dispatcher() {
+    utils::scoped_options_resource scope(&this->arena);
+    utils::for_each(this->parsers, functors::construct_options());
+    this->verbs_table = utils::enumerate(this->parsers, functors::get_verb_entry());
+    this->sorted_table = utils::sort_verb_table(this->verbs_table);
+  }
+
+  //! Parse and execute the verb matching the command line
+  //!
+  //! Verbs write in a cxxsubs::Output flushed at the end of the dispatch, a nested dispatch write in
+  //! the output of the enclosing one.
+  //!
+  //! \return Return code of the verb, EXIT_FAILURE if none match
+  //!
+  int dispatch(const int argc, const char * const *argv) {
+    if (Output *enclosing = utils::current_output()) {
+      return this->dispatch(argc, argv, *enclosing);
+    }
+    Output output;
+    return this->dispatch(argc, argv, output);
+  }
 
-    auto verbs_list = utils::for_each(parsers, functors::get_verbs_options());
-    auto descriptions_list = utils::for_each(parsers, functors::get_description_options());
+  //! Parse and execute the verb matching the command line, verbs write in output without flushing it
+  int dispatch(const int argc, const char * const *argv, Output &output) {
+    utils::scoped_output scope(&output);
+    try {
+      // only the most specific verb is parsed and executed
+      std::size_t selected = utils::select<FirstOptionsTypes, OptionsTypes...>(this->verbs_table, argc, argv);
 
-    // inject all verb list in Completion Command
-    utils::for_each(parsers, functors::set_completions(verbs_list));
+      // parse result is allocated on the stack, the arena is released in one shot at the end of the dispatch
+      std::array<std::byte, utils::dispatch_arena_size> buffer;
+      std::pmr::monotonic_buffer_resource dispatch_arena(buffer.data(), buffer.size());
 
-    // execute all Parser
-    auto ret = utils::for_each(parsers, functors::execute_options(argc, argv));
+      // verbs list is injected in Completion Command when it is constructed
+      auto ret = utils::enumerate(this->parsers, functors::execute_options(argc, argv, selected, this->running.data(),
+                                                                           functors::set_completions(this->sorted_table.data(), this->sorted_table.size(), [this](std::size_t index) -> const VerbOptions & { return this->options_of(index); }, argc > 0 ? argv[0] : ""),
+                                                                           functors::set_dispatch([this](int argc, const char * const *argv) { return this->dispatch(argc, argv); }),
+                                                                           &this->arena, &dispatch_arena));
 
-    // Check if at least an options has match
-    bool has_match = false;
-    int returnCode = EXIT_SUCCESS;
-    for (auto &[retMatch, retExec] : ret) {
-      if (retMatch) {
-        has_match = true;
-        returnCode = retExec;
+      // Check if at least an options has match
+      bool has_match = false;
+      int returnCode = EXIT_SUCCESS;
+      for (auto &[retMatch, retExec] : ret) {
+        if (retMatch) {
+          has_match = true;
+          returnCode = retExec;
+        }
+      }
+
+      if (has_match) {
+        return returnCode;
+      }
+
+      // If no option match show help, it's rendered once
+      if (this->available.empty()) {
+        this->available = utils::render_available(this->verbs_table.data(), this->verbs_table.size());
       }
+      utils::write_text(output, this->available);
+
+    } catch (const cxxopts::OptionException &e) {
+      output << "Error: parsing options: " << e.what() << "\n";
+    }
+    return EXIT_FAILURE;
+  }
+
+  //! Print the candidates for the last word of a command line, the executable name included
+  int complete(std::string_view line) {
+    Output output;
+    return this->complete(line, output);
+  }
+
+  //! Print the candidates for the last word of a command line in output without flushing it
+  int complete(std::string_view line, Output &output) {
+    std::vector<std::string> words = utils::split_command_line(line);
+    std::string program;
+    if (!words.empty()) {
+      program = std::move(words.front());
+      words.erase(words.begin());
+    }
+    if (words.empty() || line.back() == ' ' || line.back() == '\t') {
+      words.emplace_back();
+    }
+    utils::print_candidates(output, this->sorted_table.data(), this->sorted_table.data() + this->sorted_table.size(), words,
+                            [this](std::size_t index) -> const VerbOptions & { return this->options_of(index); }, program);
+    return EXIT_SUCCESS;
+  }
+
+private:
+  //! Get the options of the verb at index in the verb table
+  const VerbOptions &options_of(std::size_t index) {
+    if (!this->options_table[index]) {
+      functors::get_verb_options get(index, &this->arena);
+      utils::enumerate(this->parsers, get);
+      this->options_table[index] = std::move(get.result);
     }
+    return *this->options_table[index];
+  }
 
-    if (has_match) {
-      return returnCode;
+  //! Options are allocated from the arena, it's released with the dispatcher
+  std::pmr::monotonic_buffer_resource arena;
+  //! Options constructed with the dispatcher or at their first dispatch
+  std::tuple<std::optional<FirstOptionsTypes>, std::optional<OptionsTypes>...> parsers;
+  std::array<utils::VerbEntry, sizeof...(OptionsTypes) + 1> verbs_table;
+  //! Same verbs sorted by path for completion
+  std::array<utils::VerbEntry, sizeof...(OptionsTypes) + 1> sorted_table;
+  std::array<bool, sizeof...(OptionsTypes) + 1> running = {};
+  //! Options of each verb, listed once at their first completion
+  std::array<std::optional<VerbOptions>, sizeof...(OptionsTypes) + 1> options_table;
+  //! List of available verbs, rendered at the first dispatch matching none
+  std::string available;
+};
+
+//! Subcommand Parser shared between threads.
+//!
+//! All options are constructed with the dispatcher and never modified afterward: each dispatch
+//! parse in its own cxxopts::ParseResult and hand it to validate and exec through a Context, so
+//! any number of threads can dispatch at the same time without lock. Options must implement the
+//! Context versions of validate and exec.
+//!
+//! \tparam FirstOptionsTypes  Used to force at least one argument in template
+//! \tparam OptionsTypes  Other template arguments
+//!
+template <typename FirstOptionsTypes, typename... OptionsTypes>
+class ConcurrentDispatcher {
+  static_assert(utils::is_concurrent<FirstOptionsTypes>::value && (utils::is_concurrent<OptionsTypes>::value && ...),
+                "ConcurrentDispatcher options must implement exec(const cxxsubs::Context &) const");
+  static_assert(!utils::has_validate<FirstOptionsTypes>::value && (!utils::has_validate<OptionsTypes>::value && ...),
+                "ConcurrentDispatcher options must implement validate(const cxxsubs::Context &) const, validate() is never called");
+  static_assert(!utils::is_typed<FirstOptionsTypes>::value && (!utils::is_typed<OptionsTypes>::value && ...),
+                "ConcurrentDispatcher options can't parse in the fields of a struct shared by all dispatches");
+
+public:
+  ConcurrentDispatcher() {
+    utils::scoped_options_resource scope(&this->arena);
+    utils::for_each(this->parsers, functors::construct_all_options());
+    this->verbs_table = utils::enumerate(this->parsers, functors::get_verb_entry());
+    this->available = utils::render_available(this->verbs_table.data(), this->verbs_table.size());
+  }
+
+  //! Parse and execute the verb matching the command line, can be called from any thread
+  //!
+  //! Verbs write in a cxxsubs::Output of the calling thread flushed at the end of the dispatch.
+  //!
+  //! \return Return code of the verb, EXIT_FAILURE if none match
+  //!
+  int dispatch(const int argc, const char * const *argv) const {
+    if (Output *enclosing = utils::current_output()) {
+      return this->dispatch(argc, argv, *enclosing);
     }
+    Output output;
+    return this->dispatch(argc, argv, output);
+  }
+
+  //! Parse and execute the verb matching the command line, verbs write in output without flushing it
+  int dispatch(const int argc, const char * const *argv, Output &output) const {
+    utils::scoped_output scope(&output);
+    try {
+      std::size_t selected = utils::select<FirstOptionsTypes, OptionsTypes...>(this->verbs_table, argc, argv);
+
+      auto ret = utils::enumerate(this->parsers, functors::execute_concurrent(argc, argv, selected));
+      for (auto &[retMatch, retExec] : ret) {
+        if (retMatch) {
+          return retExec;
+        }
+      }
+
+      // If no option match show help
+      utils::write_text(output, this->available);
 
-    // If no option match show help
-    std::cout << "Available command: " << std::endl;
-    for (std::size_t i = 0; i < verbs_list.size(); ++i) {
-      std::cout << "    - " << std::left << std::setw(20) << verbs_list[i] << descriptions_list[i] << std::endl;
+    } catch (const cxxopts::OptionException &e) {
+      output << "Error: parsing options: " << e.what() << "\n";
     }
+    return EXIT_FAILURE;
+  }
+
+private:
+  //! Options are allocated from the arena, it's released with the dispatcher
+  std::pmr::monotonic_buffer_resource arena;
+  std::tuple<std::optional<FirstOptionsTypes>, std::optional<OptionsTypes>...> parsers;
+  std::array<utils::VerbEntry, sizeof...(OptionsTypes) + 1> verbs_table;
+  //! List of available verbs, rendered with the dispatcher
+  std::string available;
+};
 
+//! Subcommand Parser.
+//!
+//! One-shot dispatch of the command line, see cxxsubs::Dispatcher. When run by bash `complete -C`
+//! only the completion candidates are printed and no verb is executed.
+//!
+//! \tparam FirstOptionsTypes  Used to force at least one argument in template
+//! \tparam OptionsTypes  Other template arguments
+//!
+template <typename FirstOptionsTypes, typename... OptionsTypes>
+int Verbs(const int argc, const char * const *argv) {
+  try {
+    Dispatcher<FirstOptionsTypes, OptionsTypes...> dispatcher;
+    std::string_view line;
+    if (utils::completion_request(argc, line)) {
+      return dispatcher.complete(line);
+    }
+    return dispatcher.dispatch(argc, argv);
   } catch (const cxxopts::OptionException &e) {
-    std::cout << "Error: parsing options: " << e.what() << std::endl;
+    // options are constructed outside of the dispatch, the error is written in its own output
+    Output output;
+    utils::current_output(output) << "Error: parsing options: " << e.what() << "\n";
   }
   return EXIT_FAILURE;
 }
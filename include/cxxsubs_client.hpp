@@ -0,0 +1,148 @@
+//
+//  cxxsubs
+//
+//  https://github.com/edmBernard/cxxsubs
+//
+//  Created by Erwan BERNARD on 23/10/2018.
+//
+//  Copyright (c) 2018 Erwan BERNARD. All rights reserved.
+//  Distributed under the Apache License, Version 2.0. (See accompanying
+//  file LICENSE or copy at http://www.apache.org/licenses/LICENSE-2.0)
+//
+
+#pragma once
+
+// Client side of cxxsubs server, it does not depend on cxxopts so the client stays small
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace cxxsubs {
+
+namespace ipc {
+
+//! Frame carrying a chunk of the command output
+constexpr char output_frame = 'o';
+//! Last frame carrying the command exit code
+constexpr char exit_frame = 'x';
+//! Largest string accepted in a frame, longer ones are rejected before any allocation
+constexpr std::uint32_t max_string_size = 1 << 20;
+//! Largest number of arguments accepted in a command line
+constexpr std::uint32_t max_arguments = 1 << 16;
+
+inline bool send_all(int fd, const void *data, std::size_t size) {
+  const char *pdata = static_cast<const char *>(data);
+  while (size > 0) {
+    ssize_t written = ::send(fd, pdata, size, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    pdata += written;
+    size -= std::size_t(written);
+  }
+  return true;
+}
+
+inline bool recv_all(int fd, void *data, std::size_t size) {
+  char *pdata = static_cast<char *>(data);
+  while (size > 0) {
+    ssize_t read = ::recv(fd, pdata, size, 0);
+    if (read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (read <= 0) {
+      return false;
+    }
+    pdata += read;
+    size -= std::size_t(read);
+  }
+  return true;
+}
+
+inline bool send_string(int fd, std::string_view text) {
+  std::uint32_t size = std::uint32_t(text.size());
+  return send_all(fd, &size, sizeof(size)) && send_all(fd, text.data(), text.size());
+}
+
+inline bool recv_string(int fd, std::string &text) {
+  std::uint32_t size = 0;
+  if (!recv_all(fd, &size, sizeof(size)) || size > max_string_size) {
+    return false;
+  }
+  text.resize(size);
+  return recv_all(fd, text.data(), size);
+}
+
+inline bool send_frame(int fd, char tag, std::string_view payload) {
+  return send_all(fd, &tag, sizeof(tag)) && send_string(fd, payload);
+}
+
+inline bool make_address(const std::string &socket_path, sockaddr_un &address) {
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+  return true;
+}
+
+} // namespace ipc
+
+//! Forward a command line to a cxxsubs server (cf. cxxsubs::ServeCommand).
+//!
+//! The command output is streamed on stdout as it arrives.
+//!
+//! \return Return code of the command, EXIT_FAILURE if the server can't be reached
+//!
+inline int Forward(const std::string &socket_path, int argc, const char * const *argv) {
+  sockaddr_un address;
+  if (!ipc::make_address(socket_path, address)) {
+    std::cerr << "Error: socket path too long: " << socket_path << std::endl;
+    return EXIT_FAILURE;
+  }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+    std::cerr << "Error: can't connect to " << socket_path << ": " << std::strerror(errno) << std::endl;
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    return EXIT_FAILURE;
+  }
+
+  std::uint32_t count = std::uint32_t(argc);
+  bool sent = ipc::send_all(fd, &count, sizeof(count));
+  for (int i = 0; sent && i < argc; ++i) {
+    sent = ipc::send_string(fd, argv[i]);
+  }
+
+  int returnCode = EXIT_FAILURE;
+  std::string payload;
+  char tag = 0;
+  while (sent && ipc::recv_all(fd, &tag, sizeof(tag)) && ipc::recv_string(fd, payload)) {
+    if (tag == ipc::output_frame) {
+      std::cout.write(payload.data(), std::streamsize(payload.size()));
+      std::cout.flush();
+    } else if (tag == ipc::exit_frame && payload.size() == sizeof(std::int32_t)) {
+      std::int32_t code = 0;
+      std::memcpy(&code, payload.data(), sizeof(code));
+      returnCode = code;
+      break;
+    }
+  }
+  ::close(fd);
+  return returnCode;
+}
+
+} // namespace cxxsubs
@@ -0,0 +1,243 @@
+//
+//  cxxsubs
+//
+//  https://github.com/edmBernard/cxxsubs
+//
+//  Created by Erwan BERNARD on 23/10/2018.
+//
+//  Copyright (c) 2018 Erwan BERNARD. All rights reserved.
+//  Distributed under the Apache License, Version 2.0. (See accompanying
+//  file LICENSE or copy at http://www.apache.org/licenses/LICENSE-2.0)
+//
+
+#pragma once
+
+#include "cxxsubs.hpp"
+#include "cxxsubs_client.hpp"
+#include <chrono>
+#include <new>
+#include <streambuf>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <vector>
+
+namespace cxxsubs {
+
+namespace ipc {
+
+//! Stream buffer sending what is written in it as output frames on a client socket
+class socket_buf : public std::streambuf {
+public:
+  socket_buf(int fd)
+      : fd(fd) {
+    this->setp(this->buffer, this->buffer + sizeof(this->buffer));
+  }
+  ~socket_buf() {
+    this->sync();
+  }
+
+protected:
+  int_type overflow(int_type ch) override {
+    if (this->sync() != 0) {
+      return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+      *this->pptr() = traits_type::to_char_type(ch);
+      this->pbump(1);
+    }
+    return traits_type::not_eof(ch);
+  }
+
+  int sync() override {
+    std::size_t size = std::size_t(this->pptr() - this->pbase());
+    if (size == 0) {
+      return 0;
+    }
+    this->setp(this->buffer, this->buffer + sizeof(this->buffer));
+    return send_frame(this->fd, output_frame, std::string_view(this->buffer, size)) ? 0 : -1;
+  }
+
+private:
+  int fd;
+  char buffer[4096];
+};
+
+//! Send std::cout to a stream buffer and mark the dispatches of this thread as remote for its scope
+class scoped_request {
+public:
+  explicit scoped_request(std::streambuf *output)
+      : previous(std::cout.rdbuf(output)), remote(utils::remote_dispatch()) {
+    utils::remote_dispatch() = true;
+  }
+  ~scoped_request() {
+    std::cout.rdbuf(this->previous);
+    utils::remote_dispatch() = this->remote;
+  }
+  scoped_request(const scoped_request &) = delete;
+  scoped_request &operator=(const scoped_request &) = delete;
+
+private:
+  std::streambuf *previous;
+  bool remote;
+};
+
+//! Read one command line from the client, dispatch it and send back its output and exit code.
+//!
+//! Command lines with too many arguments or longer than ipc::max_string_size are rejected, the
+//! connection is dropped. The built-in `serve` and `batch` commands are refused, they would block
+//! the server or read its input.
+inline void serve_one(int fd, const DispatchFunction &dispatch) {
+  std::uint32_t count = 0;
+  if (!recv_all(fd, &count, sizeof(count)) || count == 0 || count > max_arguments) {
+    return;
+  }
+  std::vector<std::string> args(count);
+  std::size_t total = 0;
+  for (auto &arg : args) {
+    if (!recv_string(fd, arg) || (total += arg.size()) > max_string_size) {
+      return;
+    }
+  }
+  std::vector<const char *> argv;
+  argv.reserve(args.size() + 1);
+  for (auto &arg : args) {
+    argv.push_back(arg.c_str());
+  }
+  argv.push_back(nullptr);
+
+  std::int32_t returnCode = EXIT_FAILURE;
+  {
+    // verbs write in an output sent to the client, std::cout is redirected too for the time of the dispatch
+    socket_buf socket(fd);
+    Output output(&socket);
+    utils::scoped_output scope(&output);
+    scoped_request request(&socket);
+    try {
+      returnCode = dispatch(int(count), argv.data());
+    } catch (const std::exception &e) {
+      output << "Error: " << e.what() << "\n";
+    } catch (...) {
+      output << "Error: unknown exception\n";
+    }
+    output.flush();
+  }
+  send_frame(fd, exit_frame, std::string_view(reinterpret_cast<const char *>(&returnCode), sizeof(returnCode)));
+}
+
+} // namespace ipc
+
+//! Serve command lines received on a Unix domain socket.
+//!
+//! Connections are handled one after the other, each one carry a single command line: a client
+//! stalls the others until it's served or its timeout expires. An existing socket at socket_path is
+//! replaced, any other file is left untouched and the server is not started. Errors are written in
+//! the output of the dispatch running the server.
+//!
+//! \param timeout  Time a client is given to send its command line and read each output frame
+//!
+//! \return EXIT_FAILURE if the socket can't be created or accept fail, otherwise never return
+//!
+inline int Serve(const std::string &socket_path, const DispatchFunction &dispatch, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+  // errors are written in the output of the dispatch running the server, if any
+  Output standard;
+  Output &output = utils::current_output(standard);
+  sockaddr_un address;
+  if (!ipc::make_address(socket_path, address)) {
+    output << "Error: socket path too long: " << socket_path << "\n";
+    return EXIT_FAILURE;
+  }
+  struct stat status;
+  if (::lstat(socket_path.c_str(), &status) == 0) {
+    if (!S_ISSOCK(status.st_mode)) {
+      output << "Error: " << socket_path << " exists and is not a socket" << "\n";
+      return EXIT_FAILURE;
+    }
+    ::unlink(socket_path.c_str());
+  }
+  int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server < 0 || ::bind(server, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || ::listen(server, SOMAXCONN) != 0) {
+    output << "Error: can't listen on " << socket_path << ": " << std::strerror(errno) << "\n";
+    if (server >= 0) {
+      ::close(server);
+    }
+    return EXIT_FAILURE;
+  }
+
+  timeval client_timeout{};
+  client_timeout.tv_sec = timeout.count() / 1000;
+  client_timeout.tv_usec = (timeout.count() % 1000) * 1000;
+  for (;;) {
+    int client = ::accept(server, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      output << "Error: accept failed: " << std::strerror(errno) << "\n";
+      break;
+    }
+    // a silent client or one that doesn't read its output only stall the others until the timeout
+    ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &client_timeout, sizeof(client_timeout));
+    ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &client_timeout, sizeof(client_timeout));
+    try {
+      ipc::serve_one(client, dispatch);
+    } catch (const std::bad_alloc &) {
+      // only this connection fail
+    }
+    ::close(client);
+  }
+  ::close(server);
+  ::unlink(socket_path.c_str());
+  return EXIT_FAILURE;
+}
+
+//! Built-in command that keep the verbs warm in a server process.
+//!
+//! Command lines are sent by cxxsubs::Forward, for example with the `client` program.
+//!
+class ServeCommand : public cxxsubs::IOptions {
+public:
+  static constexpr Verb<1> verb = {{"serve"}, "Serve commands received on a Unix domain socket"};
+
+  ServeCommand()
+      : cxxsubs::IOptions(verb) {
+
+    // clang-format off
+    this->options.add_options()
+      ("socket", "path of the Unix domain socket", cxxopts::value<std::string>())
+      ("help", "Print help");
+
+    // clang-format on
+    options.parse_positional({"socket"});
+  }
+
+  int validate() {
+    if (this->parse_result->count("help")) {
+      this->print_help();
+      return EXIT_FAILURE;
+    }
+
+    if (!this->parse_result->count("socket")) {
+      this->out() << "Error: parsing options: missing socket\n";
+      return EXIT_FAILURE;
+    }
+    // a nested server would block the one serving this client forever
+    if (utils::remote_dispatch()) {
+      this->out() << "Error: serve can't be run by a server client\n";
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  int exec() {
+    return Serve((*this->parse_result)["socket"].as<std::string>(), this->dispatch);
+  };
+
+  void set_dispatch(DispatchFunction dispatch) {
+    this->dispatch = dispatch;
+  }
+
+private:
+  DispatchFunction dispatch;
+};
+
+} // namespace cxxsubs
@@ -0,0 +1,25 @@
+//
+//  cxxsubs
+//
+//  https://github.com/edmBernard/cxxsubs
+//
+//  Created by Erwan BERNARD on 23/10/2018.
+//
+//  Copyright (c) 2018 Erwan BERNARD. All rights reserved.
+//  Distributed under the Apache License, Version 2.0. (See accompanying
+//  file LICENSE or copy at http://www.apache.org/licenses/LICENSE-2.0)
+//
+
+#include "cxxsubs_client.hpp"
+
+// Forward a command line to a program started with its `serve` verb
+//   example serve /tmp/example.sock &
+//   client /tmp/example.sock ship move titanic 1 2
+int main(int argc, const char *argv[]) {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0] << " <socket> [verbs...]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  // the socket path take the place of the program name
+  return cxxsubs::Forward(argv[1], argc - 1, argv + 1);
+}
@@ -11,6 +11,10 @@
 //
 
 #include "cxxsubs.hpp"
+#ifndef _WIN32
+#include "cxxsubs_server.hpp"
+#endif
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -18,16 +22,19 @@ using iop = cxxsubs::IOptions;
 
 class OptionsShipNew : public cxxsubs::IOptions {
 public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "new"}, "Create a new ship"};
+
   OptionsShipNew()
-      : cxxsubs::IOptions({"ship", "new"}, "Create a new ship") {
+      : cxxsubs::IOptions(verb) {
 
-    options.positional_help("<name>").show_positional_help();
+    // names are views in argv, nothing is copied even for a long list of ship
+    options.positional_help("<name>").show_positional_help().view_arguments();
 
     // clang-format off
     options.add_options()
       ("help", "Print help")
       ("n, name", "ship name",
-        cxxopts::value<std::vector<std::string>>(), "<name>")
+        cxxopts::value<std::vector<std::string_view>>(), "<name>")
       ;
     // clang-format on
 
@@ -36,23 +43,23 @@ public:
 
   int validate() {
     if (this->parse_result->count("help")) {
-      std::cout << this->options.help({""}) << std::endl;
+      this->print_help();
       return EXIT_FAILURE;
     }
 
     if (this->parse_result->count("name") < 1) {
-      std::cout << "Error: parsing options: require atleast one <name>" << std::endl;
+      this->out() << "Error: parsing options: require atleast one <name>\n";
       return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
   }
 
   int exec() {
-    std::cout << "command : " << this->get_verbs() << std::endl;
+    this->out() << "command : " << this->get_verbs() << "\n";
 
     if ((*this->parse_result).count("name")) {
-      for (auto &&i : (*this->parse_result)["name"].as<std::vector<std::string>>()) {
-        std::cout << "name :" << i << std::endl;
+      for (auto &&i : (*this->parse_result)["name"].as<std::vector<std::string_view>>()) {
+        this->out() << "name :" << i << "\n";
       }
     }
     return EXIT_SUCCESS;
@@ -61,8 +68,10 @@ public:
 
 class OptionsShipShoot : public cxxsubs::IOptions {
 public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "shoot"}, "Shoot foe or not"};
+
   OptionsShipShoot()
-      : cxxsubs::IOptions({"ship", "shoot"}, "Shoot foe or not") {
+      : cxxsubs::IOptions(verb) {
 
     options.positional_help("<x> <y>").show_positional_help();
 
@@ -77,60 +86,84 @@ public:
     // clang-format on
 
     options.parse_positional({"x", "y"});
+
+    this->help = options.handle("help");
+    this->x = options.handle("x");
+    this->y = options.handle("y");
   }
 
   int validate() {
-    if (this->parse_result->count("help")) {
-      std::cout << this->options.help({""}) << std::endl;
+    if (this->parse_result->count(this->help)) {
+      this->print_help();
       return EXIT_FAILURE;
     }
 
-    if (!this->parse_result->count("x") || !this->parse_result->count("y")) {
-      std::cout << "Error: parsing options: missing <x> or <y>" << std::endl;
+    if (!this->parse_result->count(this->x) || !this->parse_result->count(this->y)) {
+      this->out() << "Error: parsing options: missing <x> or <y>\n";
       return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
   }
 
   int exec() {
-    std::cout << "command : " << this->get_verbs() << std::endl;
+    this->out() << "command : " << this->get_verbs() << "\n";
 
-    std::cout << "x :" << (*this->parse_result)["x"].as<int>() << std::endl;
-    std::cout << "y :" << (*this->parse_result)["y"].as<int>() << std::endl;
+    this->out() << "x :" << this->parse_result->get<int>(this->x) << "\n";
+    this->out() << "y :" << this->parse_result->get<int>(this->y) << "\n";
     return EXIT_SUCCESS;
   };
+
+private:
+  // handles read the parse result by index instead of hashing the option name
+  cxxopts::OptionHandle help;
+  cxxopts::OptionHandle x;
+  cxxopts::OptionHandle y;
 };
 
-class OptionsShipMove : public cxxsubs::IOptions {
+// options of ship move are parsed straight in this struct
+struct ShipMoveArgs {
+  bool help = false;
+  std::optional<std::string> name;
+  std::optional<int> x;
+  std::optional<int> y;
+};
+
+class OptionsShipMove : public cxxsubs::TypedOptions<ShipMoveArgs> {
 public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "move"}, "Move one of your ship"};
+
   OptionsShipMove()
-      : cxxsubs::IOptions({"ship", "move"}, "Move one of your ship") {
+      : cxxsubs::TypedOptions<ShipMoveArgs>(verb) {
 
     options.positional_help("<name> <x> <y>").show_positional_help();
 
     // clang-format off
     options.add_options()
-      ("help", "Print help")
+      ("help", "Print help",
+        this->field(&ShipMoveArgs::help))
       ("n, name", "ship name",
-        cxxopts::value<std::string>(), "<name>")
+        this->field(&ShipMoveArgs::name), "<name>")
       ("x", "x coordinate",
-        cxxopts::value<int>(), "<x>")
+        this->field(&ShipMoveArgs::x), "<x>")
       ("y", "y coordinate",
-        cxxopts::value<int>(), "<y>")
+        this->field(&ShipMoveArgs::y), "<y>")
       ;
     // clang-format on
 
     options.parse_positional({"name", "x", "y"});
+
+    // names of the existing ships are offered when completing <name>
+    this->complete_values("name", []() { return std::vector<std::string>{"Enterprise", "Nautilus", "Titanic"}; });
   }
 
   int validate() {
-    if (this->parse_result->count("help")) {
-      std::cout << this->options.help({""}) << std::endl;
+    if (this->args.help) {
+      this->print_help();
       return EXIT_FAILURE;
     }
 
-    if (!this->parse_result->count("name") || !this->parse_result->count("x") || !this->parse_result->count("y")) {
-      std::cout << "Error: parsing options: missing <name>, <x> or <y>" << std::endl;
+    if (!this->args.name || !this->args.x || !this->args.y) {
+      this->out() << "Error: parsing options: missing <name>, <x> or <y>\n";
       return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
@@ -138,19 +171,21 @@ public:
   }
 
   int exec() {
-    std::cout << "command : " << this->get_verbs() << std::endl;
+    this->out() << "command : " << this->get_verbs() << "\n";
 
-    std::cout << "name :" << (*this->parse_result)["name"].as<std::string>() << std::endl;
-    std::cout << "x :" << (*this->parse_result)["x"].as<int>() << std::endl;
-    std::cout << "y :" << (*this->parse_result)["y"].as<int>() << std::endl;
+    this->out() << "name :" << *this->args.name << "\n";
+    this->out() << "x :" << *this->args.x << "\n";
+    this->out() << "y :" << *this->args.y << "\n";
     return EXIT_SUCCESS;
   };
 };
 
 class OptionsMineSet : public cxxsubs::IOptions {
 public:
+  static constexpr cxxsubs::Verb<2> verb = {{"mine", "set"}, "Put a mine in the field"};
+
   OptionsMineSet()
-      : cxxsubs::IOptions({"mine", "set"}, "Put a mine in the field") {
+      : cxxsubs::IOptions(verb) {
 
     options.positional_help("<x> <y>").show_positional_help();
 
@@ -169,41 +204,56 @@ public:
     // clang-format on
 
     options.parse_positional({"x", "y"});
+
+    this->help = options.handle("help");
+    this->x = options.handle("x");
+    this->y = options.handle("y");
+    this->moored = options.handle("moored");
+    this->drifting = options.handle("drifting");
   }
 
   int validate() {
-    if (this->parse_result->count("help")) {
-      std::cout << this->options.help({""}) << std::endl;
+    if (this->parse_result->count(this->help)) {
+      this->print_help();
       return EXIT_FAILURE;
     }
 
-    if (!this->parse_result->count("x") || !this->parse_result->count("y")) {
-      std::cout << "Error: parsing options: missing <x> or <y>" << std::endl;
+    if (!this->parse_result->count(this->x) || !this->parse_result->count(this->y)) {
+      this->out() << "Error: parsing options: missing <x> or <y>\n";
       return EXIT_FAILURE;
     }
 
-    if (this->parse_result->count("moored") && this->parse_result->count("drifting")) {
-      std::cout << "Error: parsing options: drifting and moored are exclusived option" << std::endl;
+    if (this->parse_result->count(this->moored) && this->parse_result->count(this->drifting)) {
+      this->out() << "Error: parsing options: drifting and moored are exclusived option\n";
       return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
   }
 
   int exec() {
-    std::cout << "command : " << this->get_verbs() << std::endl;
+    this->out() << "command : " << this->get_verbs() << "\n";
 
-    std::cout << "x :" << (*this->parse_result)["x"].as<int>() << std::endl;
-    std::cout << "y :" << (*this->parse_result)["y"].as<int>() << std::endl;
-    std::cout << "moored :" << this->parse_result->count("moored") << std::endl;
-    std::cout << "drifting :" << this->parse_result->count("drifting") << std::endl;
+    this->out() << "x :" << this->parse_result->get<int>(this->x) << "\n";
+    this->out() << "y :" << this->parse_result->get<int>(this->y) << "\n";
+    this->out() << "moored :" << this->parse_result->count(this->moored) << "\n";
+    this->out() << "drifting :" << this->parse_result->count(this->drifting) << "\n";
     return EXIT_SUCCESS;
   };
+
+private:
+  cxxopts::OptionHandle help;
+  cxxopts::OptionHandle x;
+  cxxopts::OptionHandle y;
+  cxxopts::OptionHandle moored;
+  cxxopts::OptionHandle drifting;
 };
 
 class OptionsMineRemove : public cxxsubs::IOptions {
 public:
+  static constexpr cxxsubs::Verb<2> verb = {{"mine", "remove"}, "Remove a mine"};
+
   OptionsMineRemove()
-      : cxxsubs::IOptions({"mine", "remove"}, "Remove a mine") {
+      : cxxsubs::IOptions(verb) {
 
     options.positional_help("<x> <y>").show_positional_help();
 
@@ -220,28 +270,34 @@ public:
     options.parse_positional({"x", "y"});
   }
 
-  int validate() {
-    if (this->parse_result->count("help")) {
-      std::cout << this->options.help({""}) << std::endl;
+  // Context versions read the parse result of the current dispatch, this verb can be shared
+  // between threads with cxxsubs::ConcurrentDispatcher
+  int validate(const cxxsubs::Context &context) const {
+    if (context.result.count("help")) {
+      this->print_help();
       return EXIT_FAILURE;
     }
 
-    if (!this->parse_result->count("x") || !this->parse_result->count("y")) {
-      std::cout << "Error: parsing options: missing <x> or <y>" << std::endl;
+    if (!context.result.count("x") || !context.result.count("y")) {
+      context.output << "Error: parsing options: missing <x> or <y>\n";
       return EXIT_FAILURE;
     }
     return EXIT_SUCCESS;
   }
 
-  int exec() {
-    std::cout << "command : " << this->get_verbs() << std::endl;
+  int exec(const cxxsubs::Context &context) const {
+    context.output << "command : " << this->get_verbs() << "\n";
 
-    std::cout << "x :" << (*this->parse_result)["x"].as<int>() << std::endl;
-    std::cout << "y :" << (*this->parse_result)["y"].as<int>() << std::endl;
+    context.output << "x :" << context.result["x"].as<int>() << "\n";
+    context.output << "y :" << context.result["y"].as<int>() << "\n";
     return EXIT_SUCCESS;
   };
 };
 
 int main(int argc, const char * argv[]) {
-  return cxxsubs::Verbs<cxxsubs::CompletionCommand, OptionsShipNew, OptionsShipMove, OptionsShipShoot, OptionsMineSet, OptionsMineRemove>(argc, argv);
+  return cxxsubs::Verbs<cxxsubs::CompletionCommand, cxxsubs::BatchCommand,
+#ifndef _WIN32
+                        cxxsubs::ServeCommand,
+#endif
+                        OptionsShipNew, OptionsShipMove, OptionsShipShoot, OptionsMineSet, OptionsMineRemove>(argc, argv);
 }
@@ -30,7 +30,7 @@ public:
     // cxxopts::Options is accessible with this->options
     // cxxopts::ParseResult is accessible with this->parse_result (warning it's a pointer)
     if (this->parse_result->count("help")) {
-      std::cout << this->options.help({""}) << std::endl;
+      this->print_help();
       // We must return FAILURE otherwise exec member will be executed
       return EXIT_FAILURE;
     }
@@ -42,8 +42,8 @@ public:
     // Execute what you want
     // cxxopts::Options is accessible with this->options
     // cxxopts::ParseResult is accessible with this->parse_result (warning it's a pointer)
-    std::cout << "command : " << this->get_verbs() << std::endl;
-    std::cout << "module : " << (*this->parse_result)["module"].as<std::string>() << std::endl;
+    this->out() << "command : " << this->get_verbs() << "\n";
+    this->out() << "module : " << (*this->parse_result)["module"].as<std::string>() << "\n";
     return EXIT_SUCCESS;
   };
 };
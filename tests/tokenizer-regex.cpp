@@ -0,0 +1,13 @@
+// cxxopts std::regex path, built in its own namespace so it can be linked with the hand-written
+// tokenizer used everywhere else
+#undef CXXOPTS_NO_REGEX
+#define cxxopts cxxopts_regex
+#include "cxxopts.hpp"
+#undef cxxopts
+
+#include "tokenizer.hpp"
+
+std::string describe_regex(const std::string &text) {
+  namespace parser_tool = cxxopts_regex::values::parser_tool;
+  return describe(text, parser_tool::ParseArgument, parser_tool::IsTrueText, parser_tool::IsFalseText, parser_tool::SplitSwitchDef, parser_tool::SplitInteger);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <utility>
+
+//! Classification of a text by the cxxopts parser tools, compared between the regex path and the
+//! hand-written tokenizer.
+//!
+//! ParseArgument, IsTrueText, IsFalseText, SplitSwitchDef and SplitInteger results are written
+//! on one line, errors as "throw".
+//!
+template <typename ParseArgument, typename IsText, typename SplitSwitchDef, typename SplitInteger>
+std::string describe(const std::string &text, ParseArgument parse_argument, IsText is_true, IsText is_false, SplitSwitchDef split_switch_def,
+                     SplitInteger split_integer) {
+  std::string result;
+  bool matched = false;
+  auto argument = parse_argument(text.c_str(), matched);
+  result += matched ? "1" : "0";
+  if (matched) {
+    result += "|" + std::string(argument.arg_name) + "|" + (argument.grouping ? "g" : "") + (argument.set_value ? "s" : "") + "|" + std::string(argument.value);
+  }
+  result += std::string("|") + (is_true(text) ? "t" : "") + (is_false(text) ? "f" : "");
+  try {
+    std::pair<std::string, std::string> names = split_switch_def(text);
+    result += "|" + names.first + "," + names.second;
+  } catch (...) {
+    result += "|throw";
+  }
+  try {
+    auto integer = split_integer(text);
+    result += "|" + integer.negative + "," + integer.base + "," + integer.value;
+  } catch (...) {
+    result += "|throw";
+  }
+  return result;
+}
+
+//! Classification by the std::regex path of cxxopts, cf. tokenizer-regex.cpp
+std::string describe_regex(const std::string &text);
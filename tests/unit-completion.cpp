@@ -0,0 +1,379 @@
+#include "catch2/catch.hpp"
+#include "cxxsubs.hpp"
+#include <fstream>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+//! Empty directory removed with the test
+struct TemporaryDirectory {
+  TemporaryDirectory()
+      : path(std::filesystem::temp_directory_path() / ("cxxsubs-unit-" + std::to_string(::getpid()))) {
+    std::filesystem::remove_all(this->path);
+    std::filesystem::create_directories(this->path);
+  }
+  ~TemporaryDirectory() {
+    std::error_code error;
+    std::filesystem::remove_all(this->path, error);
+  }
+  std::filesystem::path path;
+};
+
+//! Write a values cache file expiring after ttl, it may be negative
+void write_values(const std::filesystem::path &file, std::chrono::milliseconds ttl, const std::vector<std::string> &values) {
+  std::ofstream output(file);
+  output << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch() + ttl).count() << "\n";
+  for (const std::string &value : values) {
+    output << value << "\n";
+  }
+}
+
+//! Expiration time and values of a cache file
+std::pair<long long, std::vector<std::string>> read_values(const std::filesystem::path &file) {
+  std::ifstream input(file);
+  std::string line;
+  std::getline(input, line);
+  long long expiration = line.empty() ? 0 : std::stoll(line);
+  std::vector<std::string> values;
+  while (std::getline(input, line)) {
+    values.push_back(line);
+  }
+  return {expiration, values};
+}
+
+//! Wait for a file written by another process
+bool wait_file(const std::filesystem::path &file, std::chrono::milliseconds timeout) {
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!std::filesystem::exists(file)) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+  return true;
+}
+
+long long now_ms() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+class OptionsShipNew : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "new"}, "Create a new ship"};
+
+  OptionsShipNew()
+      : cxxsubs::IOptions(verb) {
+    // clang-format off
+    this->options.add_options()
+      ("name", "name of the ship", cxxopts::value<std::vector<std::string>>())
+      ("help", "Print help");
+    // clang-format on
+    options.parse_positional({"name"});
+  }
+
+  int exec() {
+    return EXIT_SUCCESS;
+  }
+};
+
+class OptionsShipMove : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "move"}, "Move a ship"};
+
+  OptionsShipMove()
+      : cxxsubs::IOptions(verb) {
+    // clang-format off
+    this->options.add_options()
+      ("name", "name of the ship", cxxopts::value<std::string>())
+      ("s,speed", "speed in knots", cxxopts::value<int>());
+    // clang-format on
+    options.parse_positional({"name"});
+  }
+
+  int exec() {
+    return EXIT_SUCCESS;
+  }
+};
+
+class OptionsMineSet : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"mine", "set"}, "Set a mine"};
+
+  OptionsMineSet()
+      : cxxsubs::IOptions(verb) {
+    // clang-format off
+    this->options.add_options()
+      ("moored", "Moored (anchored) mine", cxxopts::value<bool>())
+      ("drifting", "Drifting mine", cxxopts::value<bool>());
+    // clang-format on
+  }
+
+  int exec() {
+    return EXIT_SUCCESS;
+  }
+};
+
+using CompletionDispatcher = cxxsubs::Dispatcher<OptionsShipNew, OptionsShipMove, OptionsMineSet, cxxsubs::CompletionCommand>;
+
+//! Output of a command line dispatched to the test verbs
+std::string run(std::vector<const char *> argv, int *returnCode = nullptr) {
+  CompletionDispatcher dispatcher;
+  std::string text;
+  {
+    cxxsubs::Output output(text);
+    int ret = dispatcher.dispatch(int(argv.size()), argv.data(), output);
+    if (returnCode) {
+      *returnCode = ret;
+    }
+  }
+  return text;
+}
+
+//! True if text has this line
+bool has_line(const std::string &text, const std::string &line) {
+  std::size_t position = text.find(line);
+  return position != std::string::npos && (position == 0 || text[position - 1] == '\n') &&
+         (position + line.size() == text.size() || text[position + line.size()] == '\n');
+}
+
+} // namespace
+
+TEST_CASE("values completion store the values of the callback", "[values]") {
+  TemporaryDirectory directory;
+  std::filesystem::path file = directory.path / "program" / "ship_move.name";
+  cxxsubs::ValuesCompleter completer([]() { return std::vector<std::string>{"Enterprise", "Nautilus", "Titanic"}; }, 60s, 2s);
+
+  CHECK(completer.values("", file) == std::vector<std::string>{"Enterprise", "Nautilus", "Titanic"});
+  CHECK(completer.values("N", file) == std::vector<std::string>{"Nautilus"});
+  CHECK(completer.values("X", file).empty());
+
+  REQUIRE(wait_file(file, 2s));
+  auto [expiration, values] = read_values(file);
+  CHECK(expiration > now_ms() + 50000);
+  CHECK(expiration <= now_ms() + 60000);
+  CHECK(values == std::vector<std::string>{"Enterprise", "Nautilus", "Titanic"});
+}
+
+TEST_CASE("values completion use a fresh cache file without calling the callback", "[values]") {
+  TemporaryDirectory directory;
+  std::filesystem::path file = directory.path / "ship_move.name";
+  write_values(file, 60s, {"cached", "other"});
+  cxxsubs::ValuesCompleter completer([]() { return std::vector<std::string>{"fresh"}; }, 60s, 2s);
+
+  CHECK(completer.values("", file) == std::vector<std::string>{"cached", "other"});
+  CHECK(completer.values("o", file) == std::vector<std::string>{"other"});
+  CHECK(read_values(file).second == std::vector<std::string>{"cached", "other"});
+}
+
+TEST_CASE("values completion never wait for a callback over its budget", "[values]") {
+  TemporaryDirectory directory;
+  std::filesystem::path file = directory.path / "ship_move.name";
+  auto slow = []() {
+    std::this_thread::sleep_for(500ms);
+    return std::vector<std::string>{"slow"};
+  };
+
+  SECTION("without values") {
+    cxxsubs::ValuesCompleter completer(slow, 60s, 50ms);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(completer.values("", file).empty());
+    CHECK(std::chrono::steady_clock::now() - start < 400ms);
+
+    // the values are stored for the next completion even if the completer is gone
+    REQUIRE(wait_file(file, 2s));
+    CHECK(read_values(file).second == std::vector<std::string>{"slow"});
+  }
+
+  SECTION("with expired values") {
+    write_values(file, -1s, {"stale"});
+    cxxsubs::ValuesCompleter completer(slow, 60s, 50ms);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(completer.values("", file) == std::vector<std::string>{"stale"});
+    CHECK(std::chrono::steady_clock::now() - start < 400ms);
+
+    // the values of the callback are read by a later completion
+    std::this_thread::sleep_for(700ms);
+    CHECK(completer.values("", file) == std::vector<std::string>{"slow"});
+    CHECK(read_values(file).second == std::vector<std::string>{"slow"});
+  }
+
+  SECTION("destroyed while the callback run") {
+    auto start = std::chrono::steady_clock::now();
+    {
+      cxxsubs::ValuesCompleter completer(slow, 60s, 50ms);
+      CHECK(completer.values("", file).empty());
+    }
+    CHECK(std::chrono::steady_clock::now() - start < 400ms);
+    REQUIRE(wait_file(file, 2s));
+  }
+}
+
+TEST_CASE("values completion ignore a callback that throw", "[values]") {
+  TemporaryDirectory directory;
+  std::filesystem::path file = directory.path / "ship_move.name";
+  write_values(file, -1s, {"stale"});
+  cxxsubs::ValuesCompleter completer([]() -> std::vector<std::string> { throw std::runtime_error("no values"); }, 60s, 2s);
+
+  CHECK(completer.values("", file) == std::vector<std::string>{"stale"});
+  CHECK(read_values(file).second == std::vector<std::string>{"stale"});
+}
+
+TEST_CASE("candidates cache only replace the caches of the same executable", "[completion]") {
+  TemporaryDirectory directory;
+  const char *others[] = {"example.1.2.3", "example.10.20.30", "example.foo.1.2.3", "example.1.2", "example.1.2.3.4", "example.a.2.3",
+                          "example.1.2.3.tmp42", "example..2.3", "other.1.2.3", "examples.1.2.3"};
+  for (const char *name : others) {
+    std::ofstream(directory.path / name) << "\n";
+  }
+
+  std::string cache = (directory.path / "example.7.8.9").string();
+  int returnCode = EXIT_FAILURE;
+  CHECK(run({"prog", "completion", "--write_cache", cache.c_str()}, &returnCode).empty());
+  CHECK(returnCode == EXIT_SUCCESS);
+
+  std::vector<std::string> names;
+  for (const auto &file : std::filesystem::directory_iterator(directory.path)) {
+    names.push_back(file.path().filename().string());
+  }
+  std::sort(names.begin(), names.end());
+  CHECK(names == std::vector<std::string>{"example..2.3", "example.1.2", "example.1.2.3.4", "example.1.2.3.tmp42", "example.7.8.9", "example.a.2.3",
+                                          "example.foo.1.2.3", "examples.1.2.3", "other.1.2.3"});
+
+  std::ifstream input(cache);
+  std::string line;
+  std::vector<std::string> lines;
+  while (std::getline(input, line)) {
+    lines.push_back(line);
+  }
+  CHECK(std::find(lines.begin(), lines.end(), "=\tcompletion mine ship") != lines.end());
+  CHECK(std::find(lines.begin(), lines.end(), "=ship\tmove new") != lines.end());
+  CHECK(std::find(lines.begin(), lines.end(), "*mine set\t--moored --drifting") != lines.end());
+}
+
+TEST_CASE("bash script run the executable or bake its candidates", "[completion]") {
+  SECTION("dynamic") {
+    std::string script = run({"prog", "completion", "--show", "--exec_name", "prog"});
+    CHECK(has_line(script, "_prog_completions() {"));
+    CHECK(has_line(script, "  type_list=$(prog completion -- \"${args[@]:1}\")"));
+    CHECK(has_line(script, "complete -F _prog_completions prog"));
+  }
+
+  SECTION("static") {
+    int returnCode = EXIT_FAILURE;
+    std::string script = run({"prog", "completion", "--show", "--exec_name", "prog", "--static"}, &returnCode);
+    CHECK(returnCode == EXIT_SUCCESS);
+    // the executable is never run
+    CHECK(script.find("prog completion") == std::string::npos);
+    CHECK(has_line(script, "    \"\") candidates=\"completion mine ship\" ;;"));
+    CHECK(has_line(script, "    \"ship\") candidates=\"move new\" ;;"));
+    CHECK(has_line(script, "    \"mine\") candidates=\"set\" ;;"));
+    CHECK(has_line(script, "    \"ship move\") candidates=\"--name --speed -s\" ;;"));
+    CHECK(has_line(script, "    \"ship move \"*) candidates=\"--name --speed -s\" ;;"));
+    CHECK(has_line(script, "    \"mine set\") candidates=\"--moored --drifting\" ;;"));
+    CHECK(has_line(script, "    *) candidates=\"\" ;;"));
+    CHECK(has_line(script, "complete -o default -F _prog_completions prog"));
+  }
+}
+
+
+TEST_CASE("cached bash script read the candidates cache of the executable", "[completion]") {
+  std::string script = run({"prog", "completion", "--show", "--exec_name", "prog", "--cache"});
+  // the cache is named after the identity of the executable and written when it's missing
+  CHECK(has_line(script, "  executable=$(type -P prog) || return 0"));
+  CHECK(has_line(script, "  key=$(stat -L -c '%i.%Y.%s' \"${executable}\" 2>/dev/null || stat -L -f '%i.%m.%z' \"${executable}\") || return 0"));
+  CHECK(has_line(script, "  cache=\"${XDG_CACHE_HOME:-${HOME}/.cache}/cxxsubs/prog.${key}\""));
+  CHECK(has_line(script, "    \"${executable}\" completion --write_cache \"${cache}\" > /dev/null || return 0"));
+  CHECK(has_line(script, "  done < \"${cache}\""));
+  CHECK(has_line(script, "complete -o default -F _prog_completions prog"));
+}
+
+TEST_CASE("zsh and fish scripts describe the verbs and options", "[completion]") {
+  SECTION("zsh") {
+    std::string script = run({"prog", "completion", "--show", "--exec_name", "prog", "--shell", "zsh"});
+    CHECK(script.rfind("#compdef prog\n", 0) == 0);
+    CHECK(has_line(script, "      candidates=('completion:Completion Command for bash, zsh and fish' 'mine' 'ship')"));
+    CHECK(has_line(script, "      candidates=('move:Move a ship' 'new:Create a new ship')"));
+    CHECK(has_line(script, "      _describe -t verbs 'verb' candidates && ret=0"));
+    CHECK(has_line(script, "      _arguments -s '--name[name of the ship]:name:' '(-s --speed)'{-s,--speed}'[speed in knots]:speed:' '1:<name>: ' && ret=0"));
+    CHECK(has_line(script, "      _arguments -s '--moored[Moored (anchored) mine]' '--drifting[Drifting mine]' && ret=0"));
+    // repeated options and positional arguments
+    CHECK(has_line(script, "      _arguments -s '*''--name[name of the ship]:name:' '--help[Print help]' '*:<name>: ' && ret=0"));
+    CHECK(has_line(script, "compdef _prog prog"));
+  }
+
+  SECTION("fish") {
+    std::string script = run({"prog", "completion", "--show", "--exec_name", "prog", "--shell", "fish"});
+    CHECK(has_line(script, "    for verb in 'completion' 'ship move' 'mine set' 'ship new'"));
+    CHECK(has_line(script, "complete -c prog -f -n '__fish_prog_words_is \\'\\'' -a 'mine'"));
+    CHECK(has_line(script, "complete -c prog -f -n '__fish_prog_words_is \\'ship\\'' -a 'move' -d 'Move a ship <name>'"));
+    CHECK(has_line(script, "complete -c prog -n '__fish_prog_verb_is \\'ship move\\'' -l 'speed' -s 's' -r -d 'speed in knots'"));
+    CHECK(has_line(script, "complete -c prog -n '__fish_prog_verb_is \\'mine set\\'' -l 'moored' -d 'Moored (anchored) mine'"));
+  }
+
+  SECTION("unknown shell") {
+    int returnCode = EXIT_SUCCESS;
+    CHECK(run({"prog", "completion", "--show", "--exec_name", "prog", "--shell", "tcsh"}, &returnCode) == "Error: parsing options: unknown shell 'tcsh'\n");
+    CHECK(returnCode == EXIT_FAILURE);
+  }
+}
+
+TEST_CASE("completion give the verbs, then the options of the matched verb", "[completion]") {
+  CHECK(run({"prog", "completion", "--", ""}) == "completion\nmine\nship\n");
+  CHECK(run({"prog", "completion", "--", "sh"}) == "ship\n");
+  CHECK(run({"prog", "completion", "--", "ship", ""}) == "move\nnew\n");
+  CHECK(run({"prog", "completion", "--", "ship", "m"}) == "move\n");
+  // options are offered once the word start with a dash
+  CHECK(run({"prog", "completion", "--", "ship", "move", ""}).empty());
+  CHECK(run({"prog", "completion", "--", "ship", "move", "-"}) == "--name\n--speed\n-s\n");
+  CHECK(run({"prog", "completion", "--", "ship", "move", "--sp"}) == "--speed\n");
+  // options stay offered after other arguments of the verb
+  CHECK(run({"prog", "completion", "--", "ship", "move", "Nautilus", "-s", "3", "-"}) == "--name\n--speed\n-s\n");
+  CHECK(run({"prog", "completion", "--", "mine", "set", "--"}) == "--moored\n--drifting\n");
+  CHECK(run({"prog", "completion", "--", "mine", "fly", "-"}).empty());
+  CHECK(run({"prog", "completion", "--", "-"}).empty());
+}
+
+TEST_CASE("direct completion read the command line in COMP_LINE and COMP_POINT", "[completion]") {
+  CHECK(run({"prog", "completion", "--show", "--exec_name", "prog", "--direct"}) == "complete -o default -C prog prog\n");
+
+  // candidates printed when bash run the executable for this line and cursor
+  auto complete = [](const char *line, const char *point) {
+    ::setenv("COMP_LINE", line, 1);
+    ::setenv("COMP_POINT", point, 1);
+    std::string_view request;
+    // bash give the executable, the word to complete and the previous word
+    bool requested = cxxsubs::utils::completion_request(4, request);
+    ::unsetenv("COMP_LINE");
+    ::unsetenv("COMP_POINT");
+    REQUIRE(requested);
+
+    CompletionDispatcher dispatcher;
+    std::string text;
+    {
+      cxxsubs::Output output(text);
+      CHECK(dispatcher.complete(request, output) == EXIT_SUCCESS);
+    }
+    return text;
+  };
+
+  CHECK(complete("prog ", "5") == "completion\nmine\nship\n");
+  CHECK(complete("prog ship m", "11") == "move\n");
+  CHECK(complete("prog ship move --s", "18") == "--speed\n");
+  CHECK(complete("prog  mine  set  -", "18") == "--moored\n--drifting\n");
+  // the words after the cursor are ignored
+  CHECK(complete("prog ship move --s", "7") == "ship\n");
+  CHECK(complete("prog ship ", "99") == "move\nnew\n");
+
+  SECTION("not run by bash") {
+    std::string_view request;
+    ::setenv("COMP_LINE", "prog ship", 1);
+    CHECK(!cxxsubs::utils::completion_request(4, request));
+    ::setenv("COMP_POINT", "9", 1);
+    CHECK(!cxxsubs::utils::completion_request(2, request));
+    ::unsetenv("COMP_LINE");
+    CHECK(!cxxsubs::utils::completion_request(4, request));
+    ::unsetenv("COMP_POINT");
+  }
+}
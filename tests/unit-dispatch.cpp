@@ -0,0 +1,628 @@
+#include "catch2/catch.hpp"
+#include "cxxsubs.hpp"
+#include <fcntl.h>
+#include <sstream>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+//! Number of exec calls by verb index in the tests
+int executed[4] = {};
+//! Number of constructions by verb index in the tests
+int constructed[4] = {};
+
+class OptionsShip : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<1> verb = {{"ship"}, "ship"};
+
+  OptionsShip()
+      : cxxsubs::IOptions(verb) {
+    ++constructed[0];
+  }
+
+  int validate() {
+    return EXIT_SUCCESS;
+  }
+
+  int exec() {
+    ++executed[0];
+    return EXIT_SUCCESS;
+  }
+};
+
+class OptionsShipNew : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "new"}, "ship new"};
+
+  OptionsShipNew()
+      : cxxsubs::IOptions(verb) {
+    ++constructed[1];
+    // clang-format off
+    this->options.add_options()
+      ("name", "name of the ship", cxxopts::value<std::vector<std::string>>());
+    // clang-format on
+    options.parse_positional({"name"});
+  }
+
+  int validate() {
+    return EXIT_SUCCESS;
+  }
+
+  int exec() {
+    ++executed[1];
+    return EXIT_SUCCESS;
+  }
+};
+
+class OptionsShipMove : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "move"}, "ship move"};
+
+  OptionsShipMove()
+      : cxxsubs::IOptions(verb) {
+    ++constructed[2];
+  }
+
+  int validate() {
+    return EXIT_SUCCESS;
+  }
+
+  int exec() {
+    ++executed[2];
+    return EXIT_SUCCESS;
+  }
+};
+
+//! Verbs given at runtime are matched without the verb table
+class OptionsShipNewFast : public cxxsubs::IOptions {
+public:
+  OptionsShipNewFast()
+      : cxxsubs::IOptions({"ship", "new", "fast"}, "ship new fast") {
+    ++constructed[3];
+  }
+
+  int validate() {
+    return EXIT_SUCCESS;
+  }
+
+  int exec() {
+    ++executed[3];
+    return EXIT_SUCCESS;
+  }
+};
+
+//! Parse and execute argv with a dispatcher of the test verbs, exec calls are counted
+int dispatch(std::vector<const char *> argv) {
+  std::fill(std::begin(executed), std::end(executed), 0);
+  cxxsubs::Dispatcher<OptionsShip, OptionsShipNew, OptionsShipMove, OptionsShipNewFast> dispatcher;
+  std::string output;
+  cxxsubs::Output sink(output);
+  return dispatcher.dispatch(int(argv.size()), argv.data(), sink);
+}
+
+//! Write its words in the output of the dispatch
+class OptionsEcho : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<1> verb = {{"echo"}, "echo"};
+
+  OptionsEcho()
+      : cxxsubs::IOptions(verb) {
+    // clang-format off
+    this->options.add_options()
+      ("words", "words to write", cxxopts::value<std::vector<std::string>>());
+    // clang-format on
+    options.parse_positional({"words"});
+  }
+
+  int validate() {
+    return EXIT_SUCCESS;
+  }
+
+  int exec() {
+    this->out() << "echo";
+    if (this->parse_result->count("words")) {
+      for (const auto &word : (*this->parse_result)["words"].as<std::vector<std::string>>()) {
+        this->out() << " " << word;
+      }
+    }
+    this->out() << "\n";
+    return EXIT_SUCCESS;
+  }
+};
+
+//! Dispatch `echo nested` between two lines of its own
+class OptionsNested : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<1> verb = {{"nested"}, "nested"};
+
+  OptionsNested()
+      : cxxsubs::IOptions(verb) {
+  }
+
+  int validate() {
+    return EXIT_SUCCESS;
+  }
+
+  int exec() {
+    const char *argv[] = {"prog", "echo", "nested"};
+    this->out() << "before\n";
+    int returnCode = this->dispatch(3, argv);
+    this->out() << "after\n";
+    return returnCode;
+  }
+
+  void set_dispatch(cxxsubs::DispatchFunction dispatch) {
+    this->dispatch = dispatch;
+  }
+
+private:
+  cxxsubs::DispatchFunction dispatch;
+};
+
+using OutputDispatcher = cxxsubs::Dispatcher<OptionsEcho, OptionsNested>;
+
+//! Sum its values, negative values are rejected by validate
+class OptionsSum : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<1> verb = {{"sum"}, "sum"};
+
+  OptionsSum()
+      : cxxsubs::IOptions(verb) {
+    // clang-format off
+    this->options.add_options()
+      ("values", "values to sum", cxxopts::value<std::vector<int>>());
+    // clang-format on
+    options.parse_positional({"values"});
+  }
+
+  int validate(const cxxsubs::Context &context) const override {
+    for (int value : context.result["values"].as<std::vector<int>>()) {
+      if (value < 0) {
+        context.output << "Error: negative value " << value << "\n";
+        return 2;
+      }
+    }
+    return EXIT_SUCCESS;
+  }
+
+  int exec(const cxxsubs::Context &context) const override {
+    int sum = 0;
+    for (int value : context.result["values"].as<std::vector<int>>()) {
+      sum += value;
+    }
+    context.output << "sum " << sum << "\n";
+    return sum % 2;
+  }
+};
+
+//! Concatenate its words
+class OptionsJoin : public cxxsubs::IOptions {
+public:
+  OptionsJoin()
+      : cxxsubs::IOptions({"join"}, "join") {
+    // clang-format off
+    this->options.add_options()
+      ("words", "words to join", cxxopts::value<std::vector<std::string>>());
+    // clang-format on
+    options.parse_positional({"words"});
+  }
+
+  int exec(const cxxsubs::Context &context) const override {
+    for (const auto &word : context.result["words"].as<std::vector<std::string>>()) {
+      context.output << word;
+    }
+    context.output << "\n";
+    return EXIT_SUCCESS;
+  }
+};
+
+//! Help and output used by the program outside of a dispatch
+class OptionsHelp : public cxxsubs::IOptions {
+public:
+  OptionsHelp()
+      : cxxsubs::IOptions({"help"}, "help") {
+    // clang-format off
+    this->options.add_options()
+      ("verbose", "Print more details");
+    // clang-format on
+  }
+
+  using cxxsubs::IOptions::options;
+  using cxxsubs::IOptions::out;
+  using cxxsubs::IOptions::print_help;
+};
+
+//! Count the allocations forwarded to the default resource
+class CountingResource : public std::pmr::memory_resource {
+public:
+  std::size_t allocations = 0;
+
+private:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++this->allocations;
+    return std::pmr::get_default_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override {
+    std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+//! Stream buffer keeping each write apart
+class WritesBuffer : public std::streambuf {
+public:
+  std::vector<std::string> writes;
+
+protected:
+  std::streamsize xsputn(const char *data, std::streamsize count) override {
+    this->writes.emplace_back(data, std::size_t(count));
+    return count;
+  }
+  int_type overflow(int_type ch) override {
+    this->writes.emplace_back(1, traits_type::to_char_type(ch));
+    return ch;
+  }
+};
+
+static_assert(cxxsubs::utils::has_validate<OptionsShip>::value);
+static_assert(!cxxsubs::utils::has_validate<OptionsSum>::value && !cxxsubs::utils::has_validate<OptionsJoin>::value);
+
+} // namespace
+
+TEST_CASE("lookup give the deepest static verb prefix of argv", "[dispatch]") {
+  const auto &table = cxxsubs::utils::verb_table<OptionsShip, OptionsShipNew, OptionsShipMove, OptionsShipNewFast>;
+  REQUIRE(table.size() == 3);
+
+  const char *ship_new[] = {"prog", "ship", "new", "a"};
+  const cxxsubs::utils::VerbEntry *entry = cxxsubs::utils::lookup(table, 4, ship_new);
+  REQUIRE(entry != nullptr);
+  CHECK(entry->index == 1);
+
+  const char *ship[] = {"prog", "ship", "newer"};
+  entry = cxxsubs::utils::lookup(table, 3, ship);
+  REQUIRE(entry != nullptr);
+  CHECK(entry->index == 0);
+
+  const char *mine[] = {"prog", "mine"};
+  CHECK(cxxsubs::utils::lookup(table, 2, mine) == nullptr);
+  CHECK(cxxsubs::utils::lookup(table, 1, mine) == nullptr);
+}
+
+TEST_CASE("select prefer the longest match, static or runtime verb", "[dispatch]") {
+  std::tuple<std::optional<OptionsShip>, std::optional<OptionsShipNew>, std::optional<OptionsShipMove>, std::optional<OptionsShipNewFast>> parsers;
+  cxxsubs::utils::for_each(parsers, cxxsubs::functors::construct_options());
+  auto verbs_table = cxxsubs::utils::enumerate(parsers, cxxsubs::functors::get_verb_entry());
+  auto select = [&verbs_table](std::vector<const char *> argv) {
+    return cxxsubs::utils::select<OptionsShip, OptionsShipNew, OptionsShipMove, OptionsShipNewFast>(verbs_table, int(argv.size()), argv.data());
+  };
+
+  CHECK(select({"prog", "ship"}) == 0);
+  CHECK(select({"prog", "ship", "new", "a"}) == 1);
+  CHECK(select({"prog", "ship", "move"}) == 2);
+  CHECK(select({"prog", "ship", "new", "fast"}) == 3);
+  CHECK(select({"prog", "mine"}) == 4);
+}
+
+TEST_CASE("dispatch execute only the most specific verb", "[dispatch]") {
+  CHECK(dispatch({"prog", "ship", "new", "a"}) == EXIT_SUCCESS);
+  CHECK(executed[0] == 0);
+  CHECK(executed[1] == 1);
+
+  CHECK(dispatch({"prog", "ship", "new", "fast"}) == EXIT_SUCCESS);
+  CHECK(executed[1] == 0);
+  CHECK(executed[3] == 1);
+
+  CHECK(dispatch({"prog", "mine"}) == EXIT_FAILURE);
+  CHECK(std::count(std::begin(executed), std::end(executed), 0) == 4);
+}
+
+TEST_CASE("split_command_line split words like a shell", "[dispatch]") {
+  using words = std::vector<std::string>;
+  CHECK(cxxsubs::utils::split_command_line("") == words{});
+  CHECK(cxxsubs::utils::split_command_line(" \t ") == words{});
+  CHECK(cxxsubs::utils::split_command_line("ship  new\ta\r") == words{"ship", "new", "a"});
+  CHECK(cxxsubs::utils::split_command_line("ship new 'big one' \"other one\"") == words{"ship", "new", "big one", "other one"});
+  CHECK(cxxsubs::utils::split_command_line("a\\ b c\\'d") == words{"a b", "c'd"});
+  CHECK(cxxsubs::utils::split_command_line("'a\\b' \"a\\\"b\"") == words{"a\\b", "a\"b"});
+  CHECK(cxxsubs::utils::split_command_line("'' x\"\"y") == words{"", "xy"});
+  CHECK(cxxsubs::utils::split_command_line("'unterminated quote") == words{"unterminated quote"});
+}
+
+TEST_CASE("complete find the verbs starting with the words", "[dispatch]") {
+  const auto &table = cxxsubs::utils::verb_table<OptionsShip, OptionsShipNew, OptionsShipMove>;
+  auto complete = [&table](std::vector<std::string> words) {
+    auto [first, last] = cxxsubs::utils::complete(table.data(), table.data() + table.size(), words);
+    std::vector<std::string> verbs;
+    for (; first != last; ++first) {
+      verbs.push_back(cxxsubs::utils::join(first->path, first->depth, " "));
+    }
+    return verbs;
+  };
+  using verbs = std::vector<std::string>;
+
+  CHECK(complete({""}) == verbs{"ship", "ship move", "ship new"});
+  CHECK(complete({"sh"}) == verbs{"ship", "ship move", "ship new"});
+  CHECK(complete({"ship", ""}) == verbs{"ship move", "ship new"});
+  CHECK(complete({"ship", "n"}) == verbs{"ship new"});
+  CHECK(complete({"ship", "new", ""}) == verbs{});
+  CHECK(complete({"mine"}) == verbs{});
+  // words are compared as is, regex metacharacters included
+  CHECK(complete({"sh.*"}) == verbs{});
+  CHECK(complete({"ship", "[nm]"}) == verbs{});
+}
+
+TEST_CASE("output is written to its target when flushed", "[output]") {
+  OutputDispatcher dispatcher;
+  const char *argv[] = {"prog", "echo", "a", "b"};
+
+  SECTION("string") {
+    std::string text;
+    cxxsubs::Output output(text);
+    CHECK(dispatcher.dispatch(4, argv, output) == EXIT_SUCCESS);
+    CHECK(text.empty());
+    output.flush();
+    CHECK(text == "echo a b\n");
+  }
+
+  SECTION("stream buffer") {
+    std::ostringstream stream;
+    cxxsubs::Output output(stream.rdbuf());
+    CHECK(dispatcher.dispatch(4, argv, output) == EXIT_SUCCESS);
+    CHECK(stream.str().empty());
+    output.flush();
+    CHECK(stream.str() == "echo a b\n");
+  }
+
+  SECTION("file descriptor") {
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    {
+      cxxsubs::Output output(fds[1]);
+      CHECK(dispatcher.dispatch(4, argv, output) == EXIT_SUCCESS);
+    }
+    ::close(fds[1]);
+    std::string text;
+    char buffer[64];
+    for (ssize_t size; (size = ::read(fds[0], buffer, sizeof(buffer))) > 0;) {
+      text.append(buffer, std::size_t(size));
+    }
+    ::close(fds[0]);
+    CHECK(text == "echo a b\n");
+  }
+}
+
+TEST_CASE("output larger than its buffer is written in order", "[output]") {
+  OutputDispatcher dispatcher;
+  std::string word(10000, 'x');
+  const char *argv[] = {"prog", "echo", word.c_str(), "end"};
+  std::string text;
+  cxxsubs::Output output(text);
+  CHECK(dispatcher.dispatch(4, argv, output) == EXIT_SUCCESS);
+  CHECK(!text.empty());
+  output.flush();
+  CHECK(text == "echo " + word + " end\n");
+}
+
+TEST_CASE("nested dispatch write in the output of the enclosing one", "[output]") {
+  OutputDispatcher dispatcher;
+  std::string text;
+  cxxsubs::Output output(text);
+
+  const char *nested[] = {"prog", "nested"};
+  CHECK(dispatcher.dispatch(2, nested, output) == EXIT_SUCCESS);
+  output.flush();
+  CHECK(text == "before\necho nested\nafter\n");
+
+  // outside of a dispatch the output in scope is used
+  text.clear();
+  {
+    cxxsubs::utils::scoped_output scope(&output);
+    const char *echo[] = {"prog", "echo", "scoped"};
+    CHECK(dispatcher.dispatch(3, echo) == EXIT_SUCCESS);
+  }
+  CHECK(cxxsubs::utils::current_output() == nullptr);
+  output.flush();
+  CHECK(text == "echo scoped\n");
+}
+
+TEST_CASE("unknown verb write the available verbs in the output", "[output]") {
+  OutputDispatcher dispatcher;
+  std::string text;
+  cxxsubs::Output output(text);
+  const char *argv[] = {"prog", "mine"};
+  CHECK(dispatcher.dispatch(2, argv, output) == EXIT_FAILURE);
+  output.flush();
+  CHECK(text.find("echo") != std::string::npos);
+  CHECK(text.find("nested") != std::string::npos);
+}
+
+TEST_CASE("concurrent dispatch give each thread its own result", "[concurrent]") {
+  const cxxsubs::ConcurrentDispatcher<OptionsSum, OptionsJoin> dispatcher;
+  constexpr int threads = 8;
+  constexpr int dispatches = 200;
+  int failures[threads] = {};
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&dispatcher, &failures, t]() {
+      for (int i = 0; i < dispatches; ++i) {
+        std::string a = std::to_string(t);
+        std::string b = std::to_string(i);
+        std::string negative = "-" + b;
+        std::string text;
+        int returnCode = 0;
+        std::string expected;
+        int expected_code = 0;
+        {
+          cxxsubs::Output output(text);
+          if (i % 3 == 0) {
+            const char *argv[] = {"prog", "sum", a.c_str(), b.c_str()};
+            returnCode = dispatcher.dispatch(4, argv, output);
+            expected = "sum " + std::to_string(t + i) + "\n";
+            expected_code = (t + i) % 2;
+          } else if (i % 3 == 1) {
+            const char *argv[] = {"prog", "join", a.c_str(), "-", b.c_str()};
+            returnCode = dispatcher.dispatch(5, argv, output);
+            expected = a + "-" + b + "\n";
+          } else {
+            const char *argv[] = {"prog", "sum", a.c_str(), "--", negative.c_str()};
+            returnCode = dispatcher.dispatch(5, argv, output);
+            expected = "Error: negative value " + negative + "\n";
+            expected_code = 2;
+          }
+        }
+        if (text != expected || returnCode != expected_code) {
+          ++failures[t];
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  for (int t = 0; t < threads; ++t) {
+    CHECK(failures[t] == 0);
+  }
+
+  std::string text;
+  {
+    cxxsubs::Output output(text);
+    const char *argv[] = {"prog", "mine"};
+    CHECK(dispatcher.dispatch(2, argv, output) == EXIT_FAILURE);
+  }
+  CHECK(text.find("join") != std::string::npos);
+}
+
+TEST_CASE("output outside of a dispatch write to std::cout", "[output]") {
+  std::ostringstream stream;
+  std::streambuf *previous = std::cout.rdbuf(stream.rdbuf());
+  // the standard output of a thread write in the buffer std::cout has at its first use
+  std::thread([&stream]() {
+    OptionsHelp options;
+    REQUIRE(cxxsubs::utils::current_output() == nullptr);
+    options.print_help();
+    CHECK(stream.str().find("--verbose") != std::string::npos);
+    options.out() << "direct\n";
+    CHECK(stream.str().find("direct\n") != std::string::npos);
+  }).join();
+  std::cout.rdbuf(previous);
+}
+
+TEST_CASE("parse results are allocated from the resource given to parse", "[arena]") {
+  CountingResource resource;
+  cxxopts::Options options("test", "", &resource);
+  // clang-format off
+  options.add_options()
+    ("n,name", "name", cxxopts::value<std::vector<std::string>>())
+    ("speed", "speed", cxxopts::value<int>()->default_value("3"));
+  // clang-format on
+  options.parse_positional({"name"});
+  std::size_t declared = resource.allocations;
+  REQUIRE(declared > 0);
+
+  const char *argv[] = {"test", "--speed", "5", "a", "b"};
+  const cxxopts::Options &shared = options;
+  for (int i = 0; i < 100; ++i) {
+    cxxopts::ParseResult result = shared.parse(5, argv);
+    CHECK(result["speed"].as<int>() == 5);
+  }
+  // results of a parse without resource don't use the resource of the options
+  CHECK(resource.allocations == declared);
+
+  CountingResource dispatch;
+  {
+    cxxopts::ParseResult result = shared.parse(5, argv, &dispatch);
+    CHECK(result["name"].as<std::vector<std::string>>() == std::vector<std::string>{"a", "b"});
+  }
+  CHECK(dispatch.allocations > 0);
+  CHECK(resource.allocations == declared);
+}
+
+TEST_CASE("output write a text larger than its buffer at once", "[output]") {
+  WritesBuffer target;
+  {
+    cxxsubs::Output output(&target);
+    output << std::string(3000, 'a');
+    output << std::string(10000, 'b');
+    output << "end\n";
+  }
+  REQUIRE(target.writes.size() == 3);
+  CHECK(target.writes[0] == std::string(3000, 'a'));
+  CHECK(target.writes[1] == std::string(10000, 'b'));
+  CHECK(target.writes[2] == "end\n");
+}
+
+TEST_CASE("help is wrapped to the terminal width only when the output is a terminal", "[output]") {
+  std::string text;
+  cxxsubs::Output string_output(text);
+  CHECK(string_output.descriptor() == -1);
+  WritesBuffer target;
+  CHECK(cxxsubs::Output(&target).descriptor() == -1);
+  CHECK(cxxsubs::Output().descriptor() == 1);
+  int fds[2];
+  REQUIRE(::pipe(fds) == 0);
+  CHECK(cxxsubs::Output(fds[1]).descriptor() == fds[1]);
+  CHECK(cxxsubs::utils::terminal_width(fds[1]) == 0);
+  CHECK(cxxsubs::utils::terminal_width(-1) == 0);
+  ::close(fds[0]);
+  ::close(fds[1]);
+
+  OptionsHelp options;
+  {
+    cxxsubs::utils::scoped_output scope(&string_output);
+    options.print_help();
+  }
+  string_output.flush();
+  CHECK(text == options.options.help({""}) + "\n");
+
+  // a terminal give its width
+  int terminal = ::posix_openpt(O_RDWR | O_NOCTTY);
+  if (terminal >= 0 && ::grantpt(terminal) == 0 && ::unlockpt(terminal) == 0) {
+    winsize size{};
+    size.ws_col = 40;
+    REQUIRE(::ioctl(terminal, TIOCSWINSZ, &size) == 0);
+    CHECK(cxxsubs::utils::terminal_width(terminal) == 40);
+  }
+  if (terminal >= 0) {
+    ::close(terminal);
+  }
+}
+
+TEST_CASE("only the options of the matching static verb are constructed", "[dispatch]") {
+  std::fill(std::begin(constructed), std::end(constructed), 0);
+  cxxsubs::Dispatcher<OptionsShip, OptionsShipNew, OptionsShipMove, OptionsShipNewFast> dispatcher;
+  // verbs given at runtime are only known once their options are constructed
+  CHECK(constructed[0] == 0);
+  CHECK(constructed[1] == 0);
+  CHECK(constructed[2] == 0);
+  CHECK(constructed[3] == 1);
+
+  std::string text;
+  cxxsubs::Output output(text);
+  const char *ship_new[] = {"prog", "ship", "new", "a"};
+  CHECK(dispatcher.dispatch(4, ship_new, output) == EXIT_SUCCESS);
+  CHECK(dispatcher.dispatch(4, ship_new, output) == EXIT_SUCCESS);
+  CHECK(constructed[0] == 0);
+  CHECK(constructed[1] == 1);
+  CHECK(constructed[2] == 0);
+  CHECK(constructed[3] == 1);
+
+  const char *mine[] = {"prog", "mine"};
+  CHECK(dispatcher.dispatch(2, mine, output) == EXIT_FAILURE);
+  CHECK(constructed[0] == 0);
+  CHECK(constructed[2] == 0);
+
+  std::fill(std::begin(constructed), std::end(constructed), 0);
+  const char *ship_move[] = {"prog", "ship", "move"};
+  {
+    cxxsubs::utils::scoped_output scope(&output);
+    CHECK(cxxsubs::Verbs<OptionsShip, OptionsShipNew, OptionsShipMove, OptionsShipNewFast>(3, ship_move) == EXIT_SUCCESS);
+  }
+  CHECK(constructed[0] == 0);
+  CHECK(constructed[1] == 0);
+  CHECK(constructed[2] == 1);
+}
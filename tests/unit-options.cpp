@@ -0,0 +1,225 @@
+#include "catch2/catch.hpp"
+#include "cxxsubs.hpp"
+
+namespace {
+
+//! Views of the last dispatch of OptionsView, valid as long as its argv
+std::vector<std::string_view> viewed;
+std::size_t viewed_arguments = 0;
+
+//! Names and label kept as views in argv
+class OptionsView : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<1> verb = {{"view"}, "view"};
+
+  OptionsView()
+      : cxxsubs::IOptions(verb) {
+    options.view_arguments();
+    // clang-format off
+    this->options.add_options()
+      ("l,label", "label of the names", cxxopts::value<std::string_view>()->default_value("none"))
+      ("names", "names", cxxopts::value<std::vector<std::string_view>>());
+    // clang-format on
+    options.parse_positional({"names"});
+  }
+
+  int exec() {
+    viewed.clear();
+    if (this->parse_result->count("names")) {
+      viewed = (*this->parse_result)["names"].as<std::vector<std::string_view>>();
+    }
+    viewed.push_back((*this->parse_result)["label"].as<std::string_view>());
+    viewed_arguments = this->parse_result->arguments().size();
+    return EXIT_SUCCESS;
+  }
+};
+
+//! Options of ship move parsed in a struct
+struct MoveArgs {
+  std::string name = "unnamed";
+  std::optional<int> speed;
+  bool fast = false;
+};
+
+//! Args of the last dispatch of OptionsMove
+MoveArgs moved;
+
+class OptionsMove : public cxxsubs::TypedOptions<MoveArgs> {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"ship", "move"}, "ship move"};
+
+  OptionsMove()
+      : cxxsubs::TypedOptions<MoveArgs>(verb) {
+    // clang-format off
+    this->options.add_options()
+      ("name", "name of the ship", this->field(&MoveArgs::name))
+      ("s,speed", "speed in knots", this->field(&MoveArgs::speed))
+      ("fast", "full speed", this->field(&MoveArgs::fast));
+    // clang-format on
+    options.parse_positional({"name"});
+  }
+
+  int exec() {
+    moved = this->args;
+    return EXIT_SUCCESS;
+  }
+};
+
+//! Counts and values read by handle and by name in the last dispatch of OptionsDepth
+std::vector<std::size_t> counts;
+std::vector<int> depths;
+
+class OptionsDepth : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<2> verb = {{"mine", "set"}, "mine set"};
+
+  OptionsDepth()
+      : cxxsubs::IOptions(verb) {
+    // clang-format off
+    this->options.add_options()
+      ("d,depth", "depth in meters", cxxopts::value<int>()->default_value("5"))
+      ("moored", "anchored mine");
+    // clang-format on
+    this->depth = options.handle("depth");
+    this->short_depth = options.handle("d");
+    this->moored = options.handle("moored");
+  }
+
+  int exec() {
+    counts = {this->parse_result->count(this->depth), this->parse_result->count(this->short_depth), this->parse_result->count("depth"),
+              this->parse_result->count(this->moored), this->parse_result->count("moored")};
+    depths = {this->parse_result->get<int>(this->depth), this->parse_result->get<int>(this->short_depth), (*this->parse_result)["depth"].as<int>()};
+    return EXIT_SUCCESS;
+  }
+
+private:
+  cxxopts::OptionHandle depth;
+  cxxopts::OptionHandle short_depth;
+  cxxopts::OptionHandle moored;
+};
+
+//! True if view is inside the text of one of the arguments
+bool in_argv(std::string_view view, const std::vector<std::string> &argv) {
+  for (const std::string &arg : argv) {
+    if (view.data() >= arg.data() && view.data() + view.size() <= arg.data() + arg.size()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//! Pointers in the strings of argv
+std::vector<const char *> pointers(const std::vector<std::string> &argv) {
+  std::vector<const char *> result;
+  for (const std::string &arg : argv) {
+    result.push_back(arg.c_str());
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_CASE("viewed arguments point in argv", "[options]") {
+  cxxsubs::Dispatcher<OptionsView> dispatcher;
+  std::string text;
+  cxxsubs::Output output(text);
+
+  SECTION("positional and attached values") {
+    std::vector<std::string> argv = {"prog", "view", "Nautilus", "--label=ships", "Enterprise,Titanic"};
+    std::vector<const char *> args = pointers(argv);
+    REQUIRE(dispatcher.dispatch(int(args.size()), args.data(), output) == EXIT_SUCCESS);
+
+    CHECK(viewed == std::vector<std::string_view>{"Nautilus", "Enterprise", "Titanic", "ships"});
+    for (std::string_view view : viewed) {
+      CHECK(in_argv(view, argv));
+    }
+    // nothing is copied in the arguments list
+    CHECK(viewed_arguments == 0);
+  }
+
+  SECTION("separated value and default value") {
+    std::vector<std::string> argv = {"prog", "view", "-l", "mines"};
+    std::vector<const char *> args = pointers(argv);
+    REQUIRE(dispatcher.dispatch(int(args.size()), args.data(), output) == EXIT_SUCCESS);
+    CHECK(viewed == std::vector<std::string_view>{"mines"});
+    CHECK(in_argv(viewed.back(), argv));
+
+    std::vector<std::string> other = {"prog", "view", "Nautilus"};
+    args = pointers(other);
+    REQUIRE(dispatcher.dispatch(int(args.size()), args.data(), output) == EXIT_SUCCESS);
+    CHECK(viewed == std::vector<std::string_view>{"Nautilus", "none"});
+    CHECK(in_argv(viewed.front(), other));
+    // the default value is a view in the option declaration, it outlive argv
+    CHECK(!in_argv(viewed.back(), other));
+  }
+}
+
+TEST_CASE("typed options are reset before each dispatch", "[options]") {
+  cxxsubs::Dispatcher<OptionsMove> dispatcher;
+  std::string text;
+  cxxsubs::Output output(text);
+
+  const char *first[] = {"prog", "ship", "move", "Nautilus", "-s", "12", "--fast"};
+  REQUIRE(dispatcher.dispatch(7, first, output) == EXIT_SUCCESS);
+  CHECK(moved.name == "Nautilus");
+  CHECK(moved.speed == 12);
+  CHECK(moved.fast);
+
+  // values of the first dispatch don't leak in the next one
+  const char *second[] = {"prog", "ship", "move"};
+  REQUIRE(dispatcher.dispatch(3, second, output) == EXIT_SUCCESS);
+  CHECK(moved.name == "unnamed");
+  CHECK(!moved.speed);
+  CHECK(!moved.fast);
+
+  const char *third[] = {"prog", "ship", "move", "--speed", "3"};
+  REQUIRE(dispatcher.dispatch(5, third, output) == EXIT_SUCCESS);
+  CHECK(moved.name == "unnamed");
+  CHECK(moved.speed == 3);
+  CHECK(!moved.fast);
+
+  // a failed parse leave no value either
+  const char *wrong[] = {"prog", "ship", "move", "Titanic", "--speed", "fast"};
+  CHECK(dispatcher.dispatch(6, wrong, output) == EXIT_FAILURE);
+  REQUIRE(dispatcher.dispatch(3, second, output) == EXIT_SUCCESS);
+  CHECK(moved.name == "unnamed");
+  CHECK(!moved.speed);
+}
+
+TEST_CASE("option handles read the same values as names", "[options]") {
+  cxxsubs::Dispatcher<OptionsDepth> dispatcher;
+  std::string text;
+  cxxsubs::Output output(text);
+
+  const char *given[] = {"prog", "mine", "set", "-d", "30", "--moored", "--moored"};
+  REQUIRE(dispatcher.dispatch(7, given, output) == EXIT_SUCCESS);
+  CHECK(counts == std::vector<std::size_t>{1, 1, 1, 2, 2});
+  CHECK(depths == std::vector<int>{30, 30, 30});
+
+  const char *defaults[] = {"prog", "mine", "set"};
+  REQUIRE(dispatcher.dispatch(3, defaults, output) == EXIT_SUCCESS);
+  CHECK(counts == std::vector<std::size_t>{0, 0, 0, 0, 0});
+  CHECK(depths == std::vector<int>{5, 5, 5});
+}
+
+TEST_CASE("option handles of other options have no value", "[options]") {
+  cxxopts::Options options("prog");
+  cxxopts::OptionHandle depth = options.add_option("", "d", "depth", "depth in meters", cxxopts::value<int>(), "");
+  options.add_options()("moored", "anchored mine");
+  CHECK_THROWS_AS(options.handle("drifting"), cxxopts::option_not_exists_exception);
+
+  cxxopts::Options other("prog");
+  other.add_options()("d,depth", "depth in meters", cxxopts::value<int>());
+
+  const char *argv[] = {"prog", "--depth", "30"};
+  auto result = options.parse(3, argv);
+  CHECK(result.count(depth) == 1);
+  CHECK(result.get<int>(depth) == 30);
+  CHECK(result.count(options.handle("moored")) == 0);
+
+  // the same name in other options, or no option at all, is never found
+  CHECK(result.count(other.handle("depth")) == 0);
+  CHECK_THROWS_AS(result[other.handle("depth")], cxxopts::option_not_present_exception);
+  CHECK(result.count(cxxopts::OptionHandle()) == 0);
+  CHECK_THROWS_AS(result[cxxopts::OptionHandle()], cxxopts::option_not_present_exception);
+}
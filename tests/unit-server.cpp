@@ -0,0 +1,96 @@
+#include "catch2/catch.hpp"
+#include "cxxsubs_server.hpp"
+
+namespace {
+
+//! Write its words, or throw a value that is not a std::exception
+class OptionsSay : public cxxsubs::IOptions {
+public:
+  static constexpr cxxsubs::Verb<1> verb = {{"say"}, "say"};
+
+  OptionsSay()
+      : cxxsubs::IOptions(verb) {
+    // clang-format off
+    this->options.add_options()
+      ("words", "words to write", cxxopts::value<std::vector<std::string>>())
+      ("throw", "throw an int");
+    // clang-format on
+    options.parse_positional({"words"});
+  }
+
+  int exec() {
+    if (this->parse_result->count("throw")) {
+      throw 42;
+    }
+    for (const auto &word : (*this->parse_result)["words"].as<std::vector<std::string>>()) {
+      this->out() << word << "\n";
+    }
+    return EXIT_SUCCESS;
+  }
+};
+
+using ServerDispatcher = cxxsubs::Dispatcher<OptionsSay, cxxsubs::BatchCommand, cxxsubs::ServeCommand>;
+
+//! Output and exit code of a command line served on one end of a socket pair
+std::pair<std::string, int> request(ServerDispatcher &dispatcher, std::vector<std::string> args) {
+  int fds[2];
+  REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  std::uint32_t count = std::uint32_t(args.size());
+  REQUIRE(cxxsubs::ipc::send_all(fds[0], &count, sizeof(count)));
+  for (const auto &arg : args) {
+    REQUIRE(cxxsubs::ipc::send_string(fds[0], arg));
+  }
+
+  cxxsubs::ipc::serve_one(fds[1], [&dispatcher](int argc, const char * const *argv) { return dispatcher.dispatch(argc, argv); });
+  ::close(fds[1]);
+
+  std::string output;
+  int returnCode = -1;
+  std::string payload;
+  char tag = 0;
+  while (cxxsubs::ipc::recv_all(fds[0], &tag, sizeof(tag)) && cxxsubs::ipc::recv_string(fds[0], payload)) {
+    if (tag == cxxsubs::ipc::output_frame) {
+      output += payload;
+    } else if (tag == cxxsubs::ipc::exit_frame) {
+      std::int32_t code = 0;
+      std::memcpy(&code, payload.data(), sizeof(code));
+      returnCode = code;
+    }
+  }
+  ::close(fds[0]);
+  return {output, returnCode};
+}
+
+} // namespace
+
+TEST_CASE("server send the output and exit code of a command line", "[server]") {
+  ServerDispatcher dispatcher;
+  auto [output, returnCode] = request(dispatcher, {"prog", "say", "hello", "world"});
+  CHECK(output == "hello\nworld\n");
+  CHECK(returnCode == EXIT_SUCCESS);
+}
+
+TEST_CASE("server refuse the built-in commands that would block it", "[server]") {
+  ServerDispatcher dispatcher;
+  {
+    auto [output, returnCode] = request(dispatcher, {"prog", "serve", "/tmp/cxxsubs-unit-nested.sock"});
+    CHECK(output == "Error: serve can't be run by a server client\n");
+    CHECK(returnCode == EXIT_FAILURE);
+  }
+  {
+    auto [output, returnCode] = request(dispatcher, {"prog", "batch"});
+    CHECK(output == "Error: batch can't be run by a server client\n");
+    CHECK(returnCode == EXIT_FAILURE);
+  }
+  CHECK(!cxxsubs::utils::remote_dispatch());
+}
+
+TEST_CASE("server restore std::cout after any exception", "[server]") {
+  ServerDispatcher dispatcher;
+  std::streambuf *standard = std::cout.rdbuf();
+  auto [output, returnCode] = request(dispatcher, {"prog", "say", "--throw"});
+  CHECK(output == "Error: unknown exception\n");
+  CHECK(returnCode == EXIT_FAILURE);
+  CHECK(std::cout.rdbuf() == standard);
+  CHECK(!cxxsubs::utils::remote_dispatch());
+}
@@ -0,0 +1,55 @@
+#define CXXOPTS_NO_REGEX
+#include "catch2/catch.hpp"
+#include "cxxopts.hpp"
+#include "tokenizer.hpp"
+#include <random>
+
+namespace {
+
+//! Classification by the hand-written tokenizer
+std::string describe_tokenizer(const std::string &text) {
+  namespace parser_tool = cxxopts::values::parser_tool;
+  return describe(text, parser_tool::ParseArgument, parser_tool::IsTrueText, parser_tool::IsFalseText, parser_tool::SplitSwitchDef, parser_tool::SplitInteger);
+}
+
+} // namespace
+
+TEST_CASE("tokenizer classify arguments like the regex path", "[tokenizer]") {
+  const char *cases[] = {"--", "-", "--a", "--ab", "--ab=", "--ab=c", "--ab=c=d", "--a-b_c", "--_a", "---a", "-abc", "-a1", "-a=b", "x", "",
+                         "--ab=\n", "--ab=x\ny", "--ab=x\r", "--\xc3\xa9", "-\xc3\xa9", "--ab c", "- a", "--0", "--00", "-0", "positional"};
+  for (const char *text : cases) {
+    INFO("argument: " << text);
+    CHECK(describe_tokenizer(text) == describe_regex(text));
+  }
+}
+
+TEST_CASE("tokenizer split option definitions like the regex path", "[tokenizer]") {
+  const char *cases[] = {"n, name", "n,name", "name", "n,", ",name", "a b", "n, -x", "ab,c", "n,na me", "n , name", "n,name-with_dash", "1,2", "\xc3\xa9,name"};
+  for (const char *text : cases) {
+    INFO("definition: " << text);
+    CHECK(describe_tokenizer(text) == describe_regex(text));
+  }
+}
+
+TEST_CASE("tokenizer read integers and booleans like the regex path", "[tokenizer]") {
+  const char *cases[] = {"1", "0", "-5", "+5", "12a", "0x", "-0x", "0x0", "0xfF", "-0x1g", "007", "-", "t", "T", "true", "True", "TRUE",
+                         "f", "false", "False", "no", "tru", "falsey", "1 ", " 1"};
+  for (const char *text : cases) {
+    INFO("value: " << text);
+    CHECK(describe_tokenizer(text) == describe_regex(text));
+  }
+}
+
+TEST_CASE("tokenizer match the regex path on random texts", "[tokenizer]") {
+  // characters the regexes treat specially: dash, equal, comma, blanks, line terminators, non ASCII
+  const char alphabet[] = "-=_,aZx0 \n\r\xc3";
+  std::mt19937 generator(42);
+  for (int i = 0; i < 20000; ++i) {
+    std::string text;
+    for (std::size_t k = 0, size = generator() % 8; k < size; ++k) {
+      text += alphabet[generator() % (sizeof(alphabet) - 1)];
+    }
+    INFO("text: " << text);
+    REQUIRE(describe_tokenizer(text) == describe_regex(text));
+  }
+}
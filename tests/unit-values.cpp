@@ -0,0 +1,151 @@
+#define CXXOPTS_NO_REGEX
+#include "catch2/catch.hpp"
+#include "cxxopts.hpp"
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+//! Value parsed from text, false if it's rejected
+template <typename T>
+bool parse(const std::string &text, T &value) {
+  try {
+    cxxopts::values::parse_value(text, value);
+    return true;
+  } catch (const cxxopts::argument_incorrect_type &) {
+    return false;
+  }
+}
+
+template <typename T>
+bool rejected(const std::string &text) {
+  T value{};
+  return !parse(text, value);
+}
+
+template <typename T>
+T parsed(const std::string &text) {
+  T value{};
+  REQUIRE(parse(text, value));
+  return value;
+}
+
+//! Limits of T are accepted, one past them are rejected
+template <typename T>
+void check_range(const std::string &min, const std::string &max, const std::string &below, const std::string &above) {
+  CHECK(parsed<T>(min) == std::numeric_limits<T>::min());
+  CHECK(parsed<T>(max) == std::numeric_limits<T>::max());
+  CHECK(rejected<T>(below));
+  CHECK(rejected<T>(above));
+}
+
+} // namespace
+
+TEST_CASE("integer values", "[numeric]") {
+  CHECK(parsed<int>("42") == 42);
+  CHECK(parsed<int>("-42") == -42);
+  CHECK(parsed<int>("007") == 7);
+  CHECK(parsed<int>("0") == 0);
+  CHECK(parsed<int>("-0") == 0);
+
+  SECTION("empty and sign only") {
+    CHECK(rejected<int>(""));
+    CHECK(rejected<int>("-"));
+    CHECK(rejected<int>("+"));
+    CHECK(rejected<int>("--1"));
+    CHECK(rejected<unsigned>("-"));
+  }
+
+  SECTION("overflow of each width") {
+    check_range<std::int8_t>("-128", "127", "-129", "128");
+    check_range<std::uint8_t>("0", "255", "-1", "256");
+    check_range<std::int16_t>("-32768", "32767", "-32769", "32768");
+    check_range<std::uint16_t>("0", "65535", "-1", "65536");
+    check_range<std::int32_t>("-2147483648", "2147483647", "-2147483649", "2147483648");
+    check_range<std::uint32_t>("0", "4294967295", "-1", "4294967296");
+    check_range<std::int64_t>("-9223372036854775808", "9223372036854775807", "-9223372036854775809", "9223372036854775808");
+    check_range<std::uint64_t>("0", "18446744073709551615", "-1", "18446744073709551616");
+    // narrow values never wrap around
+    CHECK(rejected<std::uint8_t>("300"));
+    CHECK(rejected<std::uint8_t>("65536"));
+    CHECK(rejected<std::int64_t>("99999999999999999999999"));
+  }
+
+  SECTION("hexadecimal") {
+    CHECK(parsed<int>("0x1f") == 31);
+    CHECK(parsed<int>("0x1F") == 31);
+    CHECK(parsed<int>("-0x10") == -16);
+    CHECK(parsed<std::uint8_t>("0xff") == 255);
+    CHECK(rejected<std::uint8_t>("0x100"));
+    CHECK(rejected<int>("0x"));
+    CHECK(rejected<int>("0xg"));
+    CHECK(rejected<int>("0X1f"));
+    CHECK(rejected<int>("1f"));
+  }
+
+  SECTION("leading plus") {
+    CHECK(rejected<int>("+1"));
+    CHECK(rejected<unsigned>("+1"));
+    CHECK(rejected<int>("0x+1"));
+  }
+
+  SECTION("spaces and trailing junk") {
+    CHECK(rejected<int>(" 1"));
+    CHECK(rejected<int>("1 "));
+    CHECK(rejected<int>("1a"));
+    CHECK(rejected<int>("1.5"));
+    CHECK(rejected<int>("1e3"));
+  }
+}
+
+TEST_CASE("floating point values", "[numeric]") {
+  CHECK(parsed<double>("1.5") == 1.5);
+  CHECK(parsed<double>("-1.5") == -1.5);
+  CHECK(parsed<double>(".5") == 0.5);
+  CHECK(parsed<double>("1e3") == 1000.0);
+  CHECK(parsed<float>("0.25") == 0.25f);
+
+  SECTION("empty and sign only") {
+    CHECK(rejected<double>(""));
+    CHECK(rejected<double>(" "));
+    CHECK(rejected<double>("-"));
+    CHECK(rejected<double>("+"));
+    CHECK(rejected<double>("+-1"));
+  }
+
+  SECTION("out of range") {
+    CHECK(rejected<double>("1e999"));
+    CHECK(rejected<double>("-1e999"));
+    CHECK(rejected<float>("1e39"));
+    // underflow give zero
+    CHECK(parsed<double>("1e-999") == 0.0);
+  }
+
+  SECTION("leading plus and spaces") {
+    CHECK(parsed<double>("+1.5") == 1.5);
+    CHECK(parsed<double>(" 1.5") == 1.5);
+    CHECK(parsed<double>("1.5 ") == 1.5);
+    CHECK(parsed<double>("\t1.5\n") == 1.5);
+  }
+
+  SECTION("hexadecimal, inf and nan") {
+    CHECK(rejected<double>("0x1p3"));
+    CHECK(rejected<double>("inf"));
+    CHECK(rejected<double>("-inf"));
+    CHECK(rejected<double>("nan"));
+  }
+
+  SECTION("trailing junk") {
+    CHECK(rejected<double>("1.5abc"));
+    CHECK(rejected<double>("1.5 x"));
+    CHECK(rejected<double>("1.5.5"));
+    CHECK(rejected<double>("1e"));
+  }
+}
+
+TEST_CASE("numeric values in containers", "[numeric]") {
+  CHECK(parsed<std::vector<int>>("1,-2,0x3") == std::vector<int>{1, -2, 3});
+  CHECK(parsed<std::vector<double>>("1.5,2") == std::vector<double>{1.5, 2.0});
+  CHECK(rejected<std::vector<int>>("1,x"));
+  CHECK(rejected<std::vector<std::uint8_t>>("1,256"));
+}